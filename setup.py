@@ -16,27 +16,31 @@ class BuildGeant4Simulation(build_py):
         subprocess.check_call(["cmake", "../src/G4LumaCam"], cwd=build_dir)
         subprocess.check_call(["cmake", "--build", "."], cwd=build_dir)
 
-        # Path to the lumacam executable
-        lumacam_executable = os.path.join(build_dir, "lumacam")
+        # Interactive and headless batch executables; a build without Geant4 UI/vis has only the latter
+        executables = [name for name in ("lumacam", "lumacam-batch")
+                       if os.path.exists(os.path.join(build_dir, name))]
 
         # Debug output
         print("Build directory:", build_dir)
-        print("Looking for lumacam executable at:", lumacam_executable)
+        print("Found executables:", ", ".join(executables) or "none")
 
-        # Check if the executable exists
-        if not os.path.exists(lumacam_executable):
-            raise FileNotFoundError("lumacam executable not found in build directory.")
+        # Check that at least one executable was built
+        if not executables:
+            raise FileNotFoundError("Neither lumacam nor lumacam-batch found in build directory.")
 
         # Create the bin directory in the package
         bin_dir = os.path.join(self.build_lib, "G4LumaCam", "bin")
         os.makedirs(bin_dir, exist_ok=True)
 
-        # Copy the executable to the package directory
-        subprocess.check_call(["cp", lumacam_executable, bin_dir])
+        # Copy the executables to the package directory and make them executable
+        for name in executables:
+            subprocess.check_call(["cp", os.path.join(build_dir, name), bin_dir])
+            os.chmod(os.path.join(bin_dir, name), 0o755)
 
-        # Make the executable executable
-        executable_path = os.path.join(bin_dir, "lumacam")
-        os.chmod(executable_path, 0o755)
+        # Photon file reader library for lumacam.reader (pure Python fallback when missing)
+        for reader_lib in ("liblumacam_reader.so", "liblumacam_reader.dylib"):
+            if os.path.exists(os.path.join(build_dir, reader_lib)):
+                subprocess.check_call(["cp", os.path.join(build_dir, reader_lib), bin_dir])
 
         # Continue with normal build process
         super().run()
@@ -89,6 +93,8 @@ setup(
     entry_points={
         "console_scripts": [
             "lumacam=G4LumaCam.run_lumacam:main",
+            "lumacam-replay=lumacam.replay:main",
+            "lumacam-retime=lumacam.retime:main",
         ]
     },
     cmdclass={
@@ -1,41 +1,89 @@
 #include "EventProcessor.hh"
 #include "ParticleGenerator.hh"
 #include "SimConfig.hh"
+#include "PerfCounters.hh"
 #include "G4Step.hh"
 #include "G4RunManager.hh"
 #include "G4SystemOfUnits.hh"
+#include "G4OpticalPhoton.hh"
+#include "G4Neutron.hh"
+#include "FastBoundaryProcess.hh"
+#include "G4ProcessManager.hh"
 #include <filesystem>
 #include <cstdlib>
+#include <iomanip>
+#include <limits>
 
 EventProcessor::EventProcessor(const G4String& name, ParticleGenerator* gen) 
     : G4VSensitiveDetector(name), neutronCount(-1), batchCount(0), eventCount(0), 
-      particleGen(gen), neutronRecorded(false), currentEventTriggerTime(-1.0) {
+      eventsProcessed(0), eventsDetailed(0), currentRunId(0), particleGen(gen), neutronRecorded(false),
+      sampleInteracted(false), currentEventTriggerTime(-1.0), boundaryProcess(nullptr),
+      stepPolicy(&EventProcessor::processStep<kGenerationInfo | kParentInfo | kNeutronVertex | kLensAcceptance>) {
     resetData();
 }
 
 EventProcessor::~EventProcessor() {
     if (dataFile.is_open()) dataFile.close();
+    if (notifyFile.is_open()) notifyFile.close();
 }
 
 void EventProcessor::Initialize(G4HCofThisEvent*) {
     resetData();
+
+    static const std::array<StepPolicy, kNumStepPolicies> stepPolicies =
+        stepPolicyTable(std::make_index_sequence<kNumStepPolicies>());
+    const G4Event* event = G4RunManager::GetRunManager()->GetCurrentEvent();
+    stepPolicy = stepPolicies[selectStepFeatures(event ? event->GetEventID() : 0)];
+}
+
+template <std::size_t... Features>
+std::array<EventProcessor::StepPolicy, sizeof...(Features)>
+EventProcessor::stepPolicyTable(std::index_sequence<Features...>) {
+    return {&EventProcessor::processStep<Features>...};
+}
+
+unsigned EventProcessor::selectStepFeatures(G4int eventId) const {
+    unsigned features = Sim::lensAcceptance ? kLensAcceptance : 0u;
+    // Generation and parent columns only appear in photon files; frames, cubes and summaries
+    // use the exit position, time and weight that every photon record carries
+    G4bool photonRecords = Sim::writePhotons && Sim::DetailedEvent(eventId);
+    if (photonRecords) features |= kGenerationInfo | kParentInfo;
+    if (photonRecords || summaryFile.is_open()) features |= kNeutronVertex;
+    return features;
 }
 
 void EventProcessor::resetData() {
     photons.clear();
     tracks.clear();
+    neutronPlaneRecords.clear();
     neutronPos[0] = neutronPos[1] = neutronPos[2] = 0.;
     neutronEnergy = 0.;
     protonEnergy = 0.;
-    lensPos[0] = lensPos[1] = 0.;
     neutronRecorded = false;
+    sampleInteracted = false;
     currentEventTriggerTime = -1.0;
 }
 
+void EventProcessor::RecordSampleInteraction(const G4ThreeVector& position) {
+    sampleVertex = position;
+    sampleInteracted = true;
+    if (neutronRecorded) {
+        neutronPos[0] = position.x();
+        neutronPos[1] = position.y();
+        neutronPos[2] = position.z();
+    }
+}
+
 G4bool EventProcessor::ProcessHits(G4Step* step, G4TouchableHistory*) {
+    PerfCounters::Scope perfScope(PerfCounters::kSD, true);
+    return (this->*stepPolicy)(step);
+}
+
+template <unsigned Features>
+G4bool EventProcessor::processStep(G4Step* step) {
     G4Track* track = step->GetTrack();
-    G4String volName = track->GetVolume()->GetName();
-    G4String particleName = track->GetDefinition()->GetParticleName();
+    const G4String& volName = track->GetVolume()->GetName();
+    const G4String& particleName = track->GetDefinition()->GetParticleName();
     G4StepPoint* preStep = step->GetPreStepPoint();
     G4StepPoint* postStep = step->GetPostStepPoint();
     G4ThreeVector prePos = preStep->GetPosition();
@@ -74,178 +122,527 @@ G4bool EventProcessor::ProcessHits(G4Step* step, G4TouchableHistory*) {
             neutronEnergy = 0.0;
             neutronPos[0] = neutronPos[1] = neutronPos[2] = 0.;
         }
+        // The sample is crossed before the scintillator, so its interactions usually precede this
+        if (sampleInteracted) {
+            neutronPos[0] = sampleVertex.x();
+            neutronPos[1] = sampleVertex.y();
+            neutronPos[2] = sampleVertex.z();
+        }
     }
 
-    // Record neutron position at first interaction in ScintPhys or SamplePhys
-    if ((volName == "ScintPhys" || volName == "SamplePhys") && parentID == 0 && particleName == "neutron") {
-        G4String processName = postStep->GetProcessDefinedStep() ? 
-                               postStep->GetProcessDefinedStep()->GetProcessName() : "None";
-        if (processName != "Transportation") {
-            neutronPos[0] = postPos.x();
-            neutronPos[1] = postPos.y();
-            neutronPos[2] = postPos.z();
-            // G4cout << "Neutron position set in " << volName << " for event " 
-            //        << G4RunManager::GetRunManager()->GetCurrentEvent()->GetEventID() 
-            //        << ": (" << neutronPos[0] / mm << ", " << neutronPos[1] / mm 
-            //        << ", " << neutronPos[2] / mm << ") mm" << G4endl;
+    // Record neutron position at interactions in ScintPhys; sample interactions arrive through
+    // RecordSampleInteraction. Neutron-plane records take their own vertex in ScintPhys, so there
+    // only sample interactions update it.
+    if constexpr ((Features & kNeutronVertex) != 0) {
+        if (volName == "ScintPhys" && !Sim::neutronPlane && parentID == 0 && particleName == "neutron") {
+            G4String processName = postStep->GetProcessDefinedStep() ? 
+                                   postStep->GetProcessDefinedStep()->GetProcessName() : "None";
+            // Fast-simulation transport to the scintillator exit leaves the momentum untouched
+            G4bool interacted = processName != "Transportation" &&
+                                postStep->GetMomentum() != preStep->GetMomentum();
+            if (interacted) {
+                neutronPos[0] = postPos.x();
+                neutronPos[1] = postPos.y();
+                neutronPos[2] = postPos.z();
+                // G4cout << "Neutron position set in " << volName << " for event " 
+                //        << G4RunManager::GetRunManager()->GetCurrentEvent()->GetEventID() 
+                //        << ": (" << neutronPos[0] / mm << ", " << neutronPos[1] / mm 
+                //        << ", " << neutronPos[2] / mm << ") mm" << G4endl;
+            }
         }
     }
 
+    if (Sim::neutronPlane) {
+        if (volName == "ScintPhys") recordNeutronPlane(step);
+        return true;
+    }
+
     // Track charged particles in scintillator
-    if (volName == "ScintPhys" && particleName != "opticalphoton") {
-        if (tracks.find(tid) == tracks.end()) {
-            G4double energy = track->GetKineticEnergy() / MeV;
-            if (parentID != 0 && energy <= 0) {
-                energy = neutronEnergy;
+    if constexpr ((Features & kParentInfo) != 0) {
+        if (volName == "ScintPhys" && particleName != "opticalphoton") {
+            if (tracks.find(tid) == tracks.end()) {
+                G4double energy = track->GetKineticEnergy() / MeV;
+                if (parentID != 0 && energy <= 0) {
+                    energy = neutronEnergy;
+                }
+                tracks[tid] = {particleName, prePos.x(), prePos.y(), prePos.z(), energy, false, 0., 0., 0., 0., 0., 0.};
             }
-            tracks[tid] = {particleName, prePos.x(), prePos.y(), prePos.z(), energy, false, 0., 0., 0., 0., 0., 0.};
-        }
 
-        G4String processName = postStep->GetProcessDefinedStep() ? 
-                               postStep->GetProcessDefinedStep()->GetProcessName() : "None";
-        if (processName == "Scintillation" || processName == "Cerenkov") {
-            tracks[tid].x = prePos.x();
-            tracks[tid].y = prePos.y();
-            tracks[tid].z = prePos.z();
-            tracks[tid].isLightProducer = true;
-            G4double currentEnergy = track->GetKineticEnergy() / MeV;
-            if (currentEnergy <= 0 && tracks[tid].energy <= 0) {
-                tracks[tid].energy = neutronEnergy;
+            G4String processName = postStep->GetProcessDefinedStep() ? 
+                                   postStep->GetProcessDefinedStep()->GetProcessName() : "None";
+            if (processName == "Scintillation" || processName == "Cerenkov") {
+                tracks[tid].x = prePos.x();
+                tracks[tid].y = prePos.y();
+                tracks[tid].z = prePos.z();
+                tracks[tid].isLightProducer = true;
+                G4double currentEnergy = track->GetKineticEnergy() / MeV;
+                if (currentEnergy <= 0 && tracks[tid].energy <= 0) {
+                    tracks[tid].energy = neutronEnergy;
+                }
             }
         }
     }
 
-    // NEW: Capture optical photon generation position and direction
-    if (particleName == "opticalphoton" && track->GetCurrentStepNumber() == 1) {
-        // First step of optical photon - record where it was created
-        if (tracks.find(tid) == tracks.end()) {
-            tracks[tid] = {"opticalphoton", 0., 0., 0., 0., false, 
-                          prePos.x(), prePos.y(), prePos.z(), 
-                          preDir.x(), preDir.y(), preDir.z()};
-        } else {
-            // Update generation info
-            tracks[tid].x0 = prePos.x();
-            tracks[tid].y0 = prePos.y();
-            tracks[tid].z0 = prePos.z();
-            tracks[tid].dx0 = preDir.x();
-            tracks[tid].dy0 = preDir.y();
-            tracks[tid].dz0 = preDir.z();
+    // Capture optical photon generation position and direction
+    if constexpr ((Features & kGenerationInfo) != 0) {
+        if (particleName == "opticalphoton" && track->GetCurrentStepNumber() == 1) {
+            // First step of optical photon - record where it was created
+            if (tracks.find(tid) == tracks.end()) {
+                tracks[tid] = {"opticalphoton", 0., 0., 0., 0., false, 
+                              prePos.x(), prePos.y(), prePos.z(), 
+                              preDir.x(), preDir.y(), preDir.z()};
+            } else {
+                // Update generation info
+                tracks[tid].x0 = prePos.x();
+                tracks[tid].y0 = prePos.y();
+                tracks[tid].z0 = prePos.z();
+                tracks[tid].dx0 = preDir.x();
+                tracks[tid].dy0 = preDir.y();
+                tracks[tid].dz0 = preDir.z();
+            }
         }
     }
 
     // Process photons that reach the monitor
-    if (volName == "MonitorPhys" && particleName == "opticalphoton") {
-        lensPos[0] = postStep->GetPosition().x() / mm + 500. * preStep->GetMomentumDirection().x();
-        lensPos[1] = postStep->GetPosition().y() / mm + 500. * preStep->GetMomentumDirection().y();
-
-        // Check if photon is within acceptance window
-        if (lensPos[0] > -27.5 && lensPos[0] < 27.5 && lensPos[1] > -27.5 && lensPos[1] < 27.5) {
-            if (tracks.find(parentID) == tracks.end()) {
-                tracks[parentID] = {"unknown", neutronPos[0], neutronPos[1], neutronPos[2], neutronEnergy, true, 0., 0., 0., 0., 0., 0.};
-            }
-            
-            if (tracks[parentID].energy <= 0) {
-                tracks[parentID].energy = neutronEnergy;
-            }
-            
-            PhotonRecord rec;
-            rec.id = track->GetTrackID();
-            rec.parentId = parentID;
-            rec.neutronId = neutronCount;
-            
-            // Position and direction at monitor
-            rec.x = prePos.x() / mm;
-            rec.y = prePos.y() / mm;
-            rec.z = 0.; 
-            rec.dx = preDir.x();
-            rec.dy = preDir.y();
-            rec.dz = preDir.z();
-            
-            // Generation position and direction
-            if (tracks.find(tid) != tracks.end()) {
-                rec.x0 = tracks[tid].x0 / mm;
-                rec.y0 = tracks[tid].y0 / mm;
-                rec.z0 = tracks[tid].z0 / mm;
-                rec.dx0 = tracks[tid].dx0;
-                rec.dy0 = tracks[tid].dy0;
-                rec.dz0 = tracks[tid].dz0;
-            } else {
-                // Fallback if generation info not found
-                rec.x0 = rec.y0 = rec.z0 = 0.;
-                rec.dx0 = rec.dy0 = rec.dz0 = 0.;
-            }
-            
-            rec.timeOfArrival = track->GetGlobalTime() / ns;
-            rec.wavelength = 1240. / (track->GetTotalEnergy() / eV);
-            rec.parentType = tracks[parentID].type;
-            rec.px = tracks[parentID].x / mm;
-            rec.py = tracks[parentID].y / mm;
-            rec.pz = tracks[parentID].z / mm;
-            rec.parentEnergy = tracks[parentID].energy;
-            rec.nx = neutronPos[0] / mm;
-            rec.ny = neutronPos[1] / mm;
-            rec.nz = neutronPos[2] / mm;
-            rec.neutronEnergy = neutronEnergy;
-            rec.pulseId = particleGen ? particleGen->getCurrentPulseIndex() : -1;
-            rec.pulseTime = currentEventTriggerTime;
-            photons.push_back(rec);
+    if (particleName == "opticalphoton") {
+        if (!Sim::ExitFaceMonitor() && volName == "MonitorPhys") {
+            recordPhoton<Features>(track, prePos, preDir, postPos);
+        } else if (Sim::ExitFaceMonitor() && volName == "ScintPhys" && leavesThroughExitFace(step)) {
+            // Nothing downstream of the exit face is recorded, so stop tracking here
+            recordPhoton<Features>(track, postPos, postStep->GetMomentumDirection(), postPos);
+            track->SetTrackStatus(fStopAndKill);
         }
     }
     return true;
 }
 
+// Neutron-plane mode: one record per neutron track entering the scintillator, in the photon record
+// layout so every output sink takes it. x, y, z, direction, toa and parentEnergy describe the entry;
+// px, py, pz is the first interaction vertex in the scintillator (the exit point if there is none)
+// and parentName the process there ("none" for no interaction); nx, ny, nz is the last sample
+// interaction or the source vertex. Nothing is tracked past that point.
+void EventProcessor::recordNeutronPlane(G4Step* step) {
+    G4Track* track = step->GetTrack();
+    if (track->GetDefinition() != G4Neutron::Definition()) {
+        track->SetTrackStatus(fStopAndKill);
+        return;
+    }
+    G4StepPoint* preStep = step->GetPreStepPoint();
+    G4StepPoint* postStep = step->GetPostStepPoint();
+    G4int tid = track->GetTrackID();
+
+    auto entry = neutronPlaneRecords.find(tid);
+    if (entry == neutronPlaneRecords.end()) {
+        const G4ThreeVector& pos = preStep->GetPosition();
+        const G4ThreeVector& dir = preStep->GetMomentumDirection();
+        PhotonRecord rec{};
+        rec.id = tid;
+        rec.parentId = track->GetParentID();
+        rec.neutronId = neutronCount;
+        rec.x = pos.x() / mm;
+        rec.y = pos.y() / mm;
+        rec.z = pos.z() / mm;
+        rec.dx = dir.x();
+        rec.dy = dir.y();
+        rec.dz = dir.z();
+        // Photon files write the generation columns, so both describe the entry here
+        rec.x0 = rec.x;
+        rec.y0 = rec.y;
+        rec.z0 = rec.z;
+        rec.dx0 = rec.dx;
+        rec.dy0 = rec.dy;
+        rec.dz0 = rec.dz;
+        rec.timeOfArrival = preStep->GetGlobalTime() / ns;
+        rec.parentType = "none";
+        rec.px = rec.x;
+        rec.py = rec.y;
+        rec.pz = rec.z;
+        rec.parentEnergy = preStep->GetKineticEnergy() / MeV;
+        rec.nx = neutronPos[0] / mm; // Last sample interaction, or the source vertex
+        rec.ny = neutronPos[1] / mm;
+        rec.nz = neutronPos[2] / mm;
+        rec.neutronEnergy = neutronEnergy;
+        rec.pulseId = particleGen ? particleGen->getCurrentPulseIndex() : -1;
+        rec.pulseTime = currentEventTriggerTime;
+        rec.weight = preStep->GetWeight();
+        photons.push_back(rec);
+        entry = neutronPlaneRecords.emplace(tid, photons.size() - 1).first;
+    }
+
+    const G4VProcess* process = postStep->GetProcessDefinedStep();
+    G4bool interacted = process && process->GetProcessType() != fTransportation &&
+                        postStep->GetMomentum() != preStep->GetMomentum();
+    if (interacted || postStep->GetStepStatus() == fGeomBoundary) {
+        PhotonRecord& rec = photons[entry->second];
+        const G4ThreeVector& vertex = postStep->GetPosition();
+        rec.px = vertex.x() / mm;
+        rec.py = vertex.y() / mm;
+        rec.pz = vertex.z() / mm;
+        if (interacted) rec.parentType = process->GetProcessName();
+        track->SetTrackStatus(fKillTrackAndSecondaries);
+    }
+}
+
+G4bool EventProcessor::leavesThroughExitFace(const G4Step* step) {
+    const G4StepPoint* postStep = step->GetPostStepPoint();
+    if (postStep->GetStepStatus() != fGeomBoundary) return false;
+    if (postStep->GetMomentumDirection().z() <= 0) return false;
+    if (postStep->GetPosition().z() < Sim::SCINT_THICKNESS - 1 * um) return false;
+
+    if (!boundaryProcess) {
+        G4ProcessVector* processes = G4OpticalPhoton::OpticalPhoton()->GetProcessManager()->GetProcessList();
+        for (size_t i = 0; i < processes->size(); ++i) {
+            if ((*processes)[i]->GetProcessName() == "OpBoundary") {
+                boundaryProcess = dynamic_cast<FastBoundaryProcess*>((*processes)[i]);
+                break;
+            }
+        }
+        if (!boundaryProcess) {
+            G4Exception("EventProcessor::leavesThroughExitFace()", "OPT001",
+                        FatalException, "OpBoundary process not found for optical photons");
+        }
+    }
+
+    // Reflected or absorbed photons stay behind; only transmitted ones reach the lens
+    G4OpBoundaryProcessStatus status = boundaryProcess->GetStatus();
+    return status == Transmission || status == FresnelRefraction;
+}
+
+template <unsigned Features>
+void EventProcessor::recordPhoton(G4Track* track, const G4ThreeVector& pos, const G4ThreeVector& dir,
+                                  const G4ThreeVector& exitPos) {
+    // Check if photon is within acceptance window
+    if constexpr ((Features & kLensAcceptance) != 0) {
+        if (!Sim::InLensWindow(exitPos, dir)) return;
+    }
+
+    G4int tid = track->GetTrackID();
+    G4int parentID = track->GetParentID();
+
+    // Columns of disabled features stay zero; they are only written for events that enable them
+    PhotonRecord rec{};
+    rec.id = tid;
+    rec.parentId = parentID;
+    rec.neutronId = neutronCount;
+    
+    // Position and direction at monitor
+    rec.x = pos.x() / mm;
+    rec.y = pos.y() / mm;
+    rec.z = 0.; 
+    rec.dx = dir.x();
+    rec.dy = dir.y();
+    rec.dz = dir.z();
+    
+    // Generation position and direction
+    if constexpr ((Features & kGenerationInfo) != 0) {
+        auto generation = tracks.find(tid);
+        if (generation != tracks.end()) {
+            rec.x0 = generation->second.x0 / mm;
+            rec.y0 = generation->second.y0 / mm;
+            rec.z0 = generation->second.z0 / mm;
+            rec.dx0 = generation->second.dx0;
+            rec.dy0 = generation->second.dy0;
+            rec.dz0 = generation->second.dz0;
+        }
+    }
+    
+    rec.timeOfArrival = track->GetGlobalTime() / ns;
+    rec.wavelength = 1240. / (track->GetTotalEnergy() / eV);
+    if constexpr ((Features & kParentInfo) != 0) {
+        auto parent = tracks.find(parentID);
+        if (parent == tracks.end()) {
+            parent = tracks.emplace(parentID, TrackData{"unknown", neutronPos[0], neutronPos[1], neutronPos[2],
+                                                        neutronEnergy, true, 0., 0., 0., 0., 0., 0.}).first;
+        }
+        if (parent->second.energy <= 0) {
+            parent->second.energy = neutronEnergy;
+        }
+        rec.parentType = parent->second.type;
+        rec.px = parent->second.x / mm;
+        rec.py = parent->second.y / mm;
+        rec.pz = parent->second.z / mm;
+        rec.parentEnergy = parent->second.energy;
+    }
+    rec.nx = neutronPos[0] / mm;
+    rec.ny = neutronPos[1] / mm;
+    rec.nz = neutronPos[2] / mm;
+    rec.neutronEnergy = neutronEnergy;
+    rec.pulseId = particleGen ? particleGen->getCurrentPulseIndex() : -1;
+    rec.pulseTime = currentEventTriggerTime;
+    rec.weight = track->GetWeight(); // Source weight times any neutron roulette weight
+    photons.push_back(rec);
+}
+
 void EventProcessor::EndOfEvent(G4HCofThisEvent*) {
-    if (eventCount == 0 && batchCount == 0) {
-        // G4cout << "EventProcessor: Starting new run with batchSize=" << Sim::batchSize << G4endl;
+    PerfCounters::Scope perfScope(PerfCounters::kSD);
+    if (!dataFile.is_open() && !codec.IsOpen()) {
+        // G4cout << "EventProcessor: Starting new batch " << batchCount << G4endl;
+        PerfCounters::Scope outputScope(PerfCounters::kOutput);
         openOutputFile();
     }
     
-    if (!photons.empty()) writeData();
+    // Photon records only for the prescaled subset; summaries and accumulators see every event
+    const G4Event* event = G4RunManager::GetRunManager()->GetCurrentEvent();
+    G4bool detailed = Sim::DetailedEvent(event ? event->GetEventID() : 0);
+    eventsProcessed++;
+    if (detailed) eventsDetailed++;
+
+    // Online accumulators can be filled for a target spectrum other than the sampled one
+    G4double spectrumWeight = 1.0;
+    if (reweighter.IsActive()) {
+        spectrumWeight = reweighter.Weight(particleGen ? particleGen->getParticleEnergy() : neutronEnergy);
+        G4double sourceWeight = (event && event->GetNumberOfPrimaryVertex() > 0)
+                                ? event->GetPrimaryVertex(0)->GetWeight() : 1.0;
+        reweighter.Count(spectrumWeight * sourceWeight);
+    }
+    
+    if (!photons.empty() && Sim::writePhotons && detailed) {
+        PerfCounters::Scope outputScope(PerfCounters::kOutput);
+        if (Sim::BinaryPhotonOutput()) codec.WriteEvent(photons);
+        else writeData();
+        if (!photonFiles.empty()) {
+            OutputFile& file = photonFiles.back();
+            if (file.rows == 0) file.firstNeutronId = neutronCount;
+            file.lastNeutronId = neutronCount;
+            file.rows += photons.size();
+        }
+    }
+    
+    if (summaryFile.is_open()) {
+        PerfCounters::Scope outputScope(PerfCounters::kOutput);
+        writeSummary(event, detailed);
+    }
+    
+    if (frames.IsOpen()) {
+        for (const auto& p : photons) {
+            frames.Fill(p.x, p.y, p.timeOfArrival, (Sim::WeightedOutput() ? p.weight : 1.0) * spectrumWeight);
+        }
+        // Pulsed events arrive in trigger order and photons never precede their trigger
+        if (!Sim::pulseTimes.empty() && currentEventTriggerTime >= 0) {
+            frames.FlushBefore(currentEventTriggerTime);
+        }
+    }
+    
+    if (tofCube.IsActive()) {
+        for (const auto& p : photons) {
+            G4double tof = (p.pulseTime >= 0) ? p.timeOfArrival - p.pulseTime : p.timeOfArrival;
+            tofCube.Fill(p.x, p.y, tof, (Sim::WeightedOutput() ? p.weight : 1.0) * spectrumWeight);
+        }
+    }
     
     if (Sim::batchSize > 0) {
         eventCount++;
         // G4cout << "EventProcessor: eventCount=" << eventCount << ", batchSize=" << Sim::batchSize << G4endl;
         if (eventCount >= Sim::batchSize) {
-            batchCount++;
-            eventCount = 0;
-            // G4cout << "EventProcessor: Starting new batch " << batchCount << G4endl;
-            openOutputFile();
+            // The next batch file is opened by the next event, so no empty trailing file is left
+            PerfCounters::Scope outputScope(PerfCounters::kOutput);
+            closeOutputFile();
         }
     }
     resetData();
 }
 
-void EventProcessor::openOutputFile() {
+void EventProcessor::BeginOfRun(G4int runId) {
+    if (Sim::frameOutput) {
+        frames.Open(Sim::OutputDirectory("SimFrames") /
+                    std::string(Sim::OutputBaseName() + "_frames_" + std::to_string(runId) + ".csv"));
+    }
+    tofCube.Reset();
+    reweighter.Reset();
+    codec.ResetReport();
+
+    photonFiles.clear();
+    eventsProcessed = eventsDetailed = 0;
+    currentRunId = runId;
+
+    if (!Sim::notifyFile.empty() && !notifyFile.is_open()) {
+        notifyFile.open(std::string(Sim::notifyFile), std::ios::app);
+        if (!notifyFile.is_open()) {
+            G4cerr << "ERROR: Failed to open notification file: " << Sim::notifyFile << G4endl;
+        }
+    }
+
+    if (Sim::neutronSummary) {
+        summaryPath = Sim::OutputDirectory("SimNeutrons") /
+                      std::string(Sim::OutputBaseName() + "_neutrons_" + std::to_string(runId) + ".csv");
+        summaryFile.open(summaryPath);
+        if (!summaryFile.is_open()) {
+            G4cerr << "ERROR: Failed to open file: " << summaryPath << G4endl;
+            G4Exception("EventProcessor::BeginOfRun()", "IO003",
+                        FatalException, "Cannot open neutron summary file");
+        }
+        summaryFile << std::fixed;
+        summaryFile << "event_id,neutron_id,pulse_id,pulse_time_ns,nx,ny,nz,neutronEnergy,"
+                    << "photons,photon_weight,mean_x,mean_y,first_toa,detailed";
+        if (Sim::WeightedOutput()) summaryFile << ",weight";
+        summaryFile << "\n";
+    }
+}
+
+void EventProcessor::EndOfRun(G4int runId) {
+    frames.Close();
+    if (tofCube.IsActive()) {
+        tofCube.Write(Sim::OutputDirectory("SimTOF") /
+                      std::string(Sim::OutputBaseName() + "_tofcube_" + std::to_string(runId) + ".bin"));
+    }
+    // Batches never span runs, so downstream readers see every file of a run closed here
+    closeOutputFile();
+    codec.PrintReport();
+    reweighter.PrintReport();
+    if (summaryFile.is_open()) summaryFile.close();
+    std::filesystem::path manifestPath = writeManifest(runId);
+    if (notifyFile.is_open()) {
+        notifyFile << "{\"type\": \"run_end\", \"run\": " << runId
+                   << ", \"batches\": " << photonFiles.size()
+                   << ", \"events\": " << eventsProcessed
+                   << ", \"manifest\": " << std::quoted(manifestPath.string()) << "}" << std::endl;
+    }
+}
+
+void EventProcessor::closeOutputFile() {
+    if (!dataFile.is_open() && !codec.IsOpen()) return;
     if (dataFile.is_open()) dataFile.close();
+    codec.Close();
 
-    std::filesystem::path currentPath = std::filesystem::current_path();
-    std::filesystem::path simPhotonsDir = currentPath / "SimPhotons";
-    
-    try {
-        std::filesystem::create_directories(simPhotonsDir);
-        // G4cout << "Created/verified directory: " << simPhotonsDir << G4endl;
-    } catch (const std::filesystem::filesystem_error& e) {
-        G4cerr << "ERROR: Failed to create directory " << simPhotonsDir << ": " << e.what() << G4endl;
-        G4Exception("EventProcessor::openOutputFile()", "IO001", 
-                    FatalException, "Cannot create SimPhotons directory");
+    // Announce the finished batch so downstream stages can start on it
+    if (notifyFile.is_open() && !photonFiles.empty()) {
+        const OutputFile& file = photonFiles.back();
+        notifyFile << "{\"type\": \"batch\", \"run\": " << currentRunId
+                   << ", \"batch\": " << file.batch
+                   << ", \"path\": " << std::quoted(file.path.string())
+                   << ", \"format\": " << std::quoted(std::string(Sim::photonFormat))
+                   << ", \"rows\": " << file.rows
+                   << ", \"neutron_id_min\": " << file.firstNeutronId
+                   << ", \"neutron_id_max\": " << file.lastNeutronId << "}" << std::endl;
     }
+    batchCount++;
+    eventCount = 0;
+}
 
-    G4String fileName = Sim::outputFileName;
-    size_t csvPos = fileName.find(".csv");
-    if (csvPos != G4String::npos) {
-        fileName = fileName.substr(0, csvPos);
+void EventProcessor::writeSummary(const G4Event* event, G4bool detailed) {
+    // Events without hits never reached ProcessHits, so take the neutron from the primary vertex
+    G4int neutronId = neutronRecorded ? neutronCount : -1;
+    G4double triggerTime = currentEventTriggerTime;
+    G4double position[3] = {neutronPos[0], neutronPos[1], neutronPos[2]};
+    G4double energy = neutronEnergy;
+    G4double eventWeight = 1.0;
+    if (event && event->GetNumberOfPrimaryVertex() > 0) {
+        G4PrimaryVertex* vertex = event->GetPrimaryVertex(0);
+        eventWeight = vertex->GetWeight();
+        if (!neutronRecorded) {
+            triggerTime = vertex->GetT0() / ns;
+            position[0] = vertex->GetX0();
+            position[1] = vertex->GetY0();
+            position[2] = vertex->GetZ0();
+            energy = particleGen ? particleGen->getParticleEnergy() : vertex->GetPrimary()->GetKineticEnergy() / MeV;
+        }
     }
 
-    if (Sim::batchSize > 0) {
-        fileName += "_" + std::to_string(batchCount) + ".csv";
+    G4double photonWeight = 0., sumX = 0., sumY = 0.;
+    G4double firstToa = std::numeric_limits<G4double>::max();
+    for (const auto& p : photons) {
+        photonWeight += p.weight;
+        sumX += p.weight * p.x;
+        sumY += p.weight * p.y;
+        firstToa = std::min(firstToa, p.timeOfArrival);
+    }
+
+    summaryFile << (event ? event->GetEventID() : -1) << ","
+                << neutronId << ","
+                << (particleGen ? particleGen->getCurrentPulseIndex() : -1) << ","
+                << std::setprecision(15) << triggerTime << ","
+                << std::setprecision(4) << position[0] / mm << "," << position[1] / mm << "," << position[2] / mm << ","
+                << energy << ","
+                << photons.size() << ","
+                << std::setprecision(8) << photonWeight << ",";
+    // Centroid and first arrival are left empty for events without detected photons
+    if (!photons.empty() && photonWeight > 0) {
+        summaryFile << std::setprecision(4) << sumX / photonWeight << "," << sumY / photonWeight << ",";
+    } else {
+        summaryFile << ",,";
+    }
+    if (!photons.empty()) summaryFile << std::setprecision(15) << firstToa;
+    summaryFile << "," << (detailed ? 1 : 0);
+    if (Sim::WeightedOutput()) summaryFile << "," << std::setprecision(8) << eventWeight;
+    summaryFile << "\n";
+}
+
+// Describes the run's outputs so analyses can rescale prescaled photon records
+std::filesystem::path EventProcessor::writeManifest(G4int runId) {
+    std::filesystem::path manifestPath = Sim::OutputDirectory("SimPhotons") /
+        std::string(Sim::OutputBaseName() + "_manifest_" + std::to_string(runId) + ".json");
+    std::ofstream manifest(manifestPath);
+    if (!manifest.is_open()) {
+        G4cerr << "ERROR: Failed to open file: " << manifestPath << G4endl;
+        return manifestPath;
+    }
+
+    auto relative = [](const std::filesystem::path& path) {
+        return path.lexically_relative(std::filesystem::current_path()).string();
+    };
+
+    manifest << "{\n"
+             << "  \"run\": " << runId << ",\n"
+             << "  \"events\": " << eventsProcessed << ",\n"
+             << "  \"detailed_events\": " << eventsDetailed << ",\n"
+             << "  \"prescale\": " << Sim::DETAIL_PRESCALE << ",\n"
+             << "  \"prescale_selection\": \"splitmix64(event_id) % prescale == 0\",\n"
+             << "  \"photon_output\": " << (Sim::writePhotons ? "true" : "false") << ",\n"
+             << "  \"photon_format\": " << std::quoted(std::string(Sim::photonFormat)) << ",\n"
+             << "  \"weighted\": " << (Sim::WeightedOutput() ? "true" : "false") << ",\n"
+             << "  \"neutron_plane\": " << (Sim::neutronPlane ? "true" : "false") << ",\n"
+             << "  \"photon_files\": [";
+    for (size_t i = 0; i < photonFiles.size(); ++i) {
+        const OutputFile& file = photonFiles[i];
+        manifest << (i ? ",\n" : "\n")
+                 << "    {\"path\": " << std::quoted(relative(file.path)) << ", \"rows\": " << file.rows
+                 << ", \"neutron_id_min\": " << file.firstNeutronId
+                 << ", \"neutron_id_max\": " << file.lastNeutronId << "}";
+    }
+    manifest << (photonFiles.empty() ? "],\n" : "\n  ],\n")
+             << "  \"neutron_summary\": ";
+    if (Sim::neutronSummary) manifest << std::quoted(relative(summaryPath));
+    else manifest << "null";
+    manifest << ",\n  \"spectrum_reweight\": ";
+    if (reweighter.IsActive()) {
+        manifest << "{\"table\": " << std::quoted(std::string(Sim::reweightFile))
+                 << ", \"neutrons\": " << reweighter.Neutrons()
+                 << ", \"effective_sample_size\": " << reweighter.EffectiveSampleSize() << "}";
     } else {
-        fileName += ".csv";
+        manifest << "null";
+    }
+    manifest << "\n}\n";
+    return manifestPath;
+}
+
+void EventProcessor::openOutputFile() {
+    closeOutputFile();
+
+    if (!Sim::writePhotons) return;
+
+    std::filesystem::path simPhotonsDir = Sim::OutputDirectory("SimPhotons");
+
+    G4String extension = Sim::BinaryPhotonOutput() ? ".lcph" : ".csv";
+    G4String fileName = Sim::OutputBaseName();
+    if (Sim::batchSize > 0 || batchCount > 0) {
+        fileName += "_" + std::to_string(batchCount) + extension;
+    } else {
+        fileName += extension;
     }
     
     std::filesystem::path fullPath = simPhotonsDir / std::string(fileName);
     
     // G4cout << "Opening output file: " << fullPath << G4endl;
     
+    if (Sim::BinaryPhotonOutput()) {
+        if (!codec.Open(fullPath, Sim::WeightedOutput())) {
+            G4Exception("EventProcessor::openOutputFile()", "IO002", 
+                        FatalException, "Cannot open output file");
+        }
+        photonFiles.push_back({fullPath, batchCount, 0, -1, -1});
+        return;
+    }
+
     dataFile.open(fullPath);
     
     if (!dataFile.is_open()) {
@@ -254,6 +651,7 @@ void EventProcessor::openOutputFile() {
                     FatalException, "Cannot open output file");
     }
 
+    photonFiles.push_back({fullPath, batchCount, 0, -1, -1});
     dataFile << std::fixed;
     
     // Updated header with generation position (x0,y0,z0) and direction (dx0,dy0,dz0)
@@ -261,7 +659,11 @@ void EventProcessor::openOutputFile() {
              << "x,y,z,dx,dy,dz,"
             //  << "x0,y0,z0,dx0,dy0,dz0,"
              << "toa,wavelength,"
-             << "parentName,px,py,pz,parentEnergy,nx,ny,nz,neutronEnergy\n";
+             << "parentName,px,py,pz,parentEnergy,nx,ny,nz,neutronEnergy";
+    if (Sim::WeightedOutput()) {
+        dataFile << ",weight";
+    }
+    dataFile << "\n";
 }
 
 void EventProcessor::writeData() {
@@ -326,7 +728,13 @@ void EventProcessor::writeData() {
                  << p.nz << ",";
         
         // MEDIUM PRECISION: neutron energy (MeV)
-        dataFile << std::setprecision(4) << p.neutronEnergy << "\n";
+        dataFile << std::setprecision(4) << p.neutronEnergy;
+        
+        // HIGH PRECISION: statistical weight
+        if (Sim::WeightedOutput()) {
+            dataFile << "," << std::setprecision(8) << p.weight;
+        }
+        dataFile << "\n";
     }
     dataFile.flush();
 }
\ No newline at end of file
@@ -2,11 +2,21 @@
 #define EVENT_PROCESSOR_HH
 #include "G4VSensitiveDetector.hh"
 #include "G4SystemOfUnits.hh"
+#include "G4ThreeVector.hh"
+#include "FrameAccumulator.hh"
+#include "TofCubeAccumulator.hh"
+#include "SpectrumReweighter.hh"
+#include "PhotonCodec.hh"
+#include <array>
+#include <utility>
 #include <vector>
 #include <map>
 #include <fstream>
+#include <filesystem>
 
 class ParticleGenerator;
+class FastBoundaryProcess;
+class G4Event;
 
 class EventProcessor : public G4VSensitiveDetector {
 public:
@@ -15,20 +25,13 @@ public:
     void Initialize(G4HCofThisEvent*) override;
     G4bool ProcessHits(G4Step*, G4TouchableHistory*) override;
     void EndOfEvent(G4HCofThisEvent*) override;
+    void BeginOfRun(G4int runId); // Prepare online accumulators for a run
+    void EndOfRun(G4int runId); // Flush online accumulators at the end of a run
+    // Primary neutron interaction in the sample, reported by the stepping action; it replaces the
+    // source vertex as the event's neutron vertex until a scintillator interaction does
+    void RecordSampleInteraction(const G4ThreeVector& position);
 
 private:
-    struct PhotonRecord {
-        G4int id, parentId, neutronId;
-        G4double x, y, z, dx, dy, dz;  // Position and direction at monitor
-        G4double x0, y0, z0, dx0, dy0, dz0;  // Position and direction at generation
-        G4double timeOfArrival;
-        G4double wavelength, parentEnergy, neutronEnergy;
-        G4String parentType;
-        G4double px, py, pz, nx, ny, nz;
-        G4int pulseId;
-        G4double pulseTime;
-    };
-
     struct TrackData {
         G4String type;
         G4double x, y, z, energy;
@@ -37,18 +40,62 @@ private:
         G4double x0, y0, z0, dx0, dy0, dz0;
     };
 
+    // Per-step bookkeeping that only some outputs need. processStep is instantiated for every
+    // combination and Initialize() picks one per event, so disabled features cost nothing per step.
+    enum StepFeature : unsigned {
+        kGenerationInfo = 1u << 0, // Optical photon generation position and direction
+        kParentInfo = 1u << 1,     // Charged light producers in the tracks map
+        kNeutronVertex = 1u << 2,  // Neutron first interaction in the sample or scintillator
+        kLensAcceptance = 1u << 3, // Drop photons outside the lens window
+        kNumStepPolicies = 1u << 4
+    };
+    using StepPolicy = G4bool (EventProcessor::*)(G4Step*);
+
+    struct OutputFile {
+        std::filesystem::path path;
+        G4int batch;
+        G4long rows;
+        G4int firstNeutronId, lastNeutronId;
+    };
+
     std::vector<PhotonRecord> photons;
     std::map<G4int, TrackData> tracks;
+    std::map<G4int, size_t> neutronPlaneRecords; // Neutron track ID -> its record in photons
     G4double neutronPos[3], neutronEnergy, protonEnergy;
-    G4double lensPos[2];
     G4int neutronCount, batchCount, eventCount;
     std::ofstream dataFile;
+    PhotonCodec codec;
+    std::vector<OutputFile> photonFiles; // Photon files written during the current run
+    std::ofstream summaryFile;
+    std::filesystem::path summaryPath;
+    G4long eventsProcessed, eventsDetailed;
+    G4int currentRunId;
+    std::ofstream notifyFile; // JSON-lines batch completion notifications
+    FrameAccumulator frames;
+    TofCubeAccumulator tofCube;
+    SpectrumReweighter reweighter; // Target-spectrum weights for frames and TOF cube
     ParticleGenerator* particleGen;
     G4bool neutronRecorded;
+    G4bool sampleInteracted; // RecordSampleInteraction was called this event
+    G4ThreeVector sampleVertex; // Its last position
     G4double currentEventTriggerTime;
+    FastBoundaryProcess* boundaryProcess;
+    StepPolicy stepPolicy; // processStep specialization for the current event
 
     void resetData();
+    unsigned selectStepFeatures(G4int eventId) const;
+    template <unsigned Features> G4bool processStep(G4Step* step);
+    template <std::size_t... Features>
+    static std::array<StepPolicy, sizeof...(Features)> stepPolicyTable(std::index_sequence<Features...>);
+    template <unsigned Features>
+    void recordPhoton(G4Track* track, const G4ThreeVector& pos, const G4ThreeVector& dir,
+                      const G4ThreeVector& exitPos);
+    G4bool leavesThroughExitFace(const G4Step* step);
+    void recordNeutronPlane(G4Step* step);
     void writeData();
+    void writeSummary(const G4Event* event, G4bool detailed);
+    std::filesystem::path writeManifest(G4int runId);
     void openOutputFile();
+    void closeOutputFile(); // Close the current batch file and announce it
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,185 @@
+#include "FastBoundaryProcess.hh"
+#include "SimConfig.hh"
+#include "G4LogicalBorderSurface.hh"
+#include "G4LogicalSkinSurface.hh"
+#include "G4LogicalVolumeStore.hh"
+#include "G4GeometryTolerance.hh"
+#include "G4Material.hh"
+#include "G4OpticalPhoton.hh"
+#include "G4OpticalSurface.hh"
+#include "G4ProcessManager.hh"
+#include "G4Step.hh"
+#include "G4ios.hh"
+
+namespace {
+    const char* kClassNames[FastBoundaryProcess::kNumClasses] = {"generic", "absorber", "transmitter"};
+
+    // A missing property takes the stock default
+    G4bool constantProperty(G4MaterialPropertiesTable* table, const char* name, G4double value, G4bool missingMatches) {
+        G4MaterialPropertyVector* property = table->GetProperty(name);
+        if (!property) return missingMatches;
+        for (size_t i = 0; i < property->GetVectorLength(); ++i) {
+            if ((*property)[i] != value) return false;
+        }
+        return true;
+    }
+}
+
+FastBoundaryProcess::FastBoundaryProcess()
+    : G4OpBoundaryProcess("OpBoundary"), status(Undefined),
+      carTolerance(G4GeometryTolerance::GetInstance()->GetSurfaceTolerance()) {
+    ResetReport();
+}
+
+void FastBoundaryProcess::BuildPhysicsTable(const G4ParticleDefinition& particle) {
+    G4OpBoundaryProcess::BuildPhysicsTable(particle);
+
+    // The RINDEX and GROUPVEL lookups the stock process repeats on every hit
+    const G4MaterialTable* materials = G4Material::GetMaterialTable();
+    hasRindex.assign(materials->size(), false);
+    groupVelocity.assign(materials->size(), nullptr);
+    for (const G4Material* material : *materials) {
+        G4MaterialPropertiesTable* table = material->GetMaterialPropertiesTable();
+        if (!table || !table->GetProperty("RINDEX")) continue;
+        hasRindex[material->GetIndex()] = true;
+        groupVelocity[material->GetIndex()] = table->GetProperty("GROUPVEL");
+    }
+
+    // Skin surfaces of the geometry; border surfaces are classified on their first hit
+    classes.clear();
+    std::map<G4String, SurfaceClass> summary;
+    for (G4LogicalVolume* volume : *G4LogicalVolumeStore::GetInstance()) {
+        G4LogicalSkinSurface* skin = G4LogicalSkinSurface::GetSurface(volume);
+        auto surface = skin ? dynamic_cast<const G4OpticalSurface*>(skin->GetSurfaceProperty()) : nullptr;
+        if (surface) summary[surface->GetName()] = classify(surface);
+    }
+    if (Sim::opticalFastPath != "off") {
+        G4cout << "Optical fast path (" << Sim::opticalFastPath << "):";
+        for (const auto& [name, surfaceClass] : summary) G4cout << " " << name << "=" << kClassNames[surfaceClass];
+        G4cout << G4endl;
+    }
+}
+
+FastBoundaryProcess::SurfaceClass FastBoundaryProcess::classify(const G4OpticalSurface* surface) {
+    auto it = classes.find(surface);
+    if (it != classes.end()) return it->second;
+
+    SurfaceClass result = kGeneric;
+    G4MaterialPropertiesTable* table = surface->GetMaterialPropertiesTable();
+    G4OpticalSurfaceModel model = surface->GetModel();
+    // REALRINDEX/IMAGINARYRINDEX would replace REFLECTIVITY by a computed one
+    if (table && (model == unified || model == glisur) && !table->GetProperty("REALRINDEX") &&
+        !table->GetProperty("IMAGINARYRINDEX")) {
+        if (surface->GetType() == dielectric_metal &&
+            constantProperty(table, "REFLECTIVITY", 0., false) &&
+            constantProperty(table, "EFFICIENCY", 0., true) &&
+            constantProperty(table, "TRANSMITTANCE", 0., true)) {
+            result = kAbsorber;
+        } else if (surface->GetType() == dielectric_dielectric && surface->GetFinish() == polished &&
+                   constantProperty(table, "REFLECTIVITY", 0., false) &&
+                   constantProperty(table, "TRANSMITTANCE", 1., false)) {
+            result = kTransmitter;
+        }
+    }
+    classes[surface] = result;
+    return result;
+}
+
+const G4OpticalSurface* FastBoundaryProcess::surfaceAt(const G4Step& step) const {
+    G4VPhysicalVolume* prePV = step.GetPreStepPoint()->GetPhysicalVolume();
+    G4VPhysicalVolume* postPV = step.GetPostStepPoint()->GetPhysicalVolume();
+    G4LogicalSurface* surface = G4LogicalBorderSurface::GetSurface(prePV, postPV);
+    if (!surface) {
+        // Entering a daughter prefers the daughter's skin, otherwise the skin being left
+        G4bool enteredDaughter = postPV->GetMotherLogical() == prePV->GetLogicalVolume();
+        G4LogicalVolume* first = enteredDaughter ? postPV->GetLogicalVolume() : prePV->GetLogicalVolume();
+        G4LogicalVolume* second = enteredDaughter ? prePV->GetLogicalVolume() : postPV->GetLogicalVolume();
+        surface = G4LogicalSkinSurface::GetSurface(first);
+        if (!surface) surface = G4LogicalSkinSurface::GetSurface(second);
+    }
+    return surface ? dynamic_cast<const G4OpticalSurface*>(surface->GetSurfaceProperty()) : nullptr;
+}
+
+FastBoundaryProcess::SurfaceClass FastBoundaryProcess::applicableClass(const G4Step& step) {
+    const G4StepPoint* postStep = step.GetPostStepPoint();
+    if (postStep->GetStepStatus() != fGeomBoundary || !postStep->GetPhysicalVolume()) return kGeneric;
+    if (step.GetTrack()->GetStepLength() <= carTolerance) return kGeneric;
+    const G4Material* preMaterial = step.GetPreStepPoint()->GetMaterial();
+    const G4Material* postMaterial = postStep->GetMaterial();
+    // G4OpBoundaryProcess passes photons between volumes of the same material (SameMaterial) before
+    // looking up any surface, so a fallback skin such as LShapeLog's must not absorb them here
+    if (preMaterial == postMaterial || preMaterial->GetIndex() >= hasRindex.size() ||
+        postMaterial->GetIndex() >= hasRindex.size() || !hasRindex[preMaterial->GetIndex()]) {
+        return kGeneric;
+    }
+
+    const G4OpticalSurface* surface = surfaceAt(step);
+    if (!surface) return kGeneric;
+    SurfaceClass surfaceClass = classify(surface);
+    if (surfaceClass == kTransmitter && !hasRindex[postMaterial->GetIndex()]) return kGeneric;
+    return surfaceClass;
+}
+
+G4VParticleChange* FastBoundaryProcess::PostStepDoIt(const G4Track& track, const G4Step& step) {
+    const G4String& mode = Sim::opticalFastPath;
+    SurfaceClass surfaceClass = mode == "off" ? kGeneric : applicableClass(step);
+    if (surfaceClass == kGeneric || mode == "check") {
+        G4VParticleChange* change = G4OpBoundaryProcess::PostStepDoIt(track, step);
+        status = G4OpBoundaryProcess::GetStatus();
+        if (surfaceClass != kGeneric) {
+            hits[surfaceClass]++;
+            G4bool agrees = surfaceClass == kAbsorber
+                ? status == Absorption && aParticleChange.GetTrackStatus() == fStopAndKill
+                : status == Transmission && aParticleChange.GetTrackStatus() == fAlive &&
+                  (*aParticleChange.GetMomentumDirection() - track.GetMomentumDirection()).mag() < 1e-9;
+            if (!agrees) mismatches[surfaceClass]++;
+        }
+        return change;
+    }
+
+    hits[surfaceClass]++;
+    aParticleChange.Initialize(track);
+    if (surfaceClass == kAbsorber) {
+        status = Absorption;
+        aParticleChange.ProposeTrackStatus(fStopAndKill);
+    } else {
+        // Direction and polarization carry over; only the group velocity of the new medium changes
+        status = Transmission;
+        G4MaterialPropertyVector* velocity = groupVelocity[step.GetPostStepPoint()->GetMaterial()->GetIndex()];
+        aParticleChange.ProposeVelocity(velocity ? velocity->Value(track.GetTotalEnergy()) : track.GetVelocity());
+    }
+    return G4VDiscreteProcess::PostStepDoIt(track, step);
+}
+
+void FastBoundaryProcess::ResetReport() {
+    for (int i = 0; i < kNumClasses; ++i) hits[i] = mismatches[i] = 0;
+}
+
+void FastBoundaryProcess::PrintReport() const {
+    if (Sim::opticalFastPath == "off" || hits[kAbsorber] + hits[kTransmitter] == 0) return;
+    G4bool checked = Sim::opticalFastPath == "check";
+    G4cout << "\n=== Optical Boundary Fast Path (" << Sim::opticalFastPath << ") ===" << G4endl;
+    for (int i = kAbsorber; i < kNumClasses; ++i) {
+        G4cout << kClassNames[i] << " hits: " << hits[i];
+        if (checked) G4cout << ", disagreeing with G4OpBoundaryProcess: " << mismatches[i];
+        G4cout << G4endl;
+    }
+    if (checked && mismatches[kAbsorber] + mismatches[kTransmitter] > 0) {
+        G4cerr << "WARNING: the optical fast path does not reproduce the stock boundary process here; "
+               << "run with /lumacam/opticalFastPath off" << G4endl;
+    }
+    G4cout << "=================================" << G4endl;
+}
+
+void FastBoundaryPhysics::ConstructProcess() {
+    G4ProcessManager* manager = G4OpticalPhoton::OpticalPhoton()->GetProcessManager();
+    G4ProcessVector* processes = manager->GetProcessList();
+    for (size_t i = 0; i < processes->size(); ++i) {
+        if ((*processes)[i]->GetProcessName() == "OpBoundary") {
+            // The manager gives up ownership of the removed process
+            delete manager->RemoveProcess((*processes)[i]);
+            manager->AddDiscreteProcess(new FastBoundaryProcess());
+            return;
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef FAST_BOUNDARY_PROCESS_HH
+#define FAST_BOUNDARY_PROCESS_HH
+
+#include "G4OpBoundaryProcess.hh"
+#include "G4VPhysicsConstructor.hh"
+#include <map>
+#include <vector>
+
+class G4OpticalSurface;
+
+// G4OpBoundaryProcess with a shortcut for the degenerate surfaces of the geometry, enabled with
+// /lumacam/opticalFastPath. Surfaces are classified once, when the physics tables are built:
+//   absorber: dielectric_metal with REFLECTIVITY, EFFICIENCY and TRANSMITTANCE zero at every
+//     energy (DarkSurface, BlackTapeSurface), where the stock process always ends in Absorption;
+//   transmitter: polished dielectric_dielectric with REFLECTIVITY 0 and TRANSMITTANCE 1
+//     (ScintSurface, MonitorSurface), where it always passes the photon on unrefracted.
+// Hits on those surfaces skip the normal, facet and property evaluation of the unified model.
+// Other surfaces, and the material cases the stock process treats specially (no RINDEX, same
+// material), go to G4OpBoundaryProcess. "check" runs the stock process on every hit and counts
+// outcomes that differ from the shortcut.
+class FastBoundaryProcess : public G4OpBoundaryProcess {
+public:
+    enum SurfaceClass { kGeneric, kAbsorber, kTransmitter, kNumClasses };
+
+    FastBoundaryProcess();
+
+    void BuildPhysicsTable(const G4ParticleDefinition& particle) override;
+    G4VParticleChange* PostStepDoIt(const G4Track& track, const G4Step& step) override;
+
+    // Status of the last step, including those resolved by the shortcut (hides the base version)
+    G4OpBoundaryProcessStatus GetStatus() const { return status; }
+
+    void ResetReport();
+    void PrintReport() const;
+
+private:
+    const G4OpticalSurface* surfaceAt(const G4Step& step) const; // Looked up as in G4OpBoundaryProcess
+    SurfaceClass classify(const G4OpticalSurface* surface);
+    SurfaceClass applicableClass(const G4Step& step); // kGeneric when the stock process must run
+
+    std::map<const G4OpticalSurface*, SurfaceClass> classes;
+    std::vector<G4bool> hasRindex; // By material index
+    std::vector<G4MaterialPropertyVector*> groupVelocity; // By material index, nullptr without GROUPVEL
+    G4OpBoundaryProcessStatus status;
+    G4double carTolerance; // Steps this short are left to the stock process (StepTooSmall)
+
+    // Per class over the run: hits resolved or checked, and checked hits where the stock process disagreed
+    G4long hits[kNumClasses], mismatches[kNumClasses];
+};
+
+// Replaces the OpBoundary process of G4OpticalPhysics with FastBoundaryProcess; register after it.
+class FastBoundaryPhysics : public G4VPhysicsConstructor {
+public:
+    FastBoundaryPhysics() : G4VPhysicsConstructor("FastBoundary") {}
+    void ConstructParticle() override {}
+    void ConstructProcess() override;
+};
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef FRAME_ACCUMULATOR_HH
+#define FRAME_ACCUMULATOR_HH
+
+#include "G4Types.hh"
+#include "G4String.hh"
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <unordered_map>
+
+// Integrates detected photons into sparse per-exposure frames for frame-based cameras.
+// Each frame spans FRAME_PULSES pulse periods (or FRAME_EXPOSURE without a pulsed beam)
+// and is written in COO form as soon as no later event can contribute to it.
+class FrameAccumulator {
+public:
+    FrameAccumulator();
+    ~FrameAccumulator();
+
+    G4bool Open(const std::filesystem::path& path);
+    G4bool IsOpen() const { return frameFile.is_open(); }
+    void Fill(G4double x, G4double y, G4double toa, G4double weight);
+    void FlushBefore(G4double time); // Write frames ending at or before time (ns)
+    void Close(); // Write remaining frames and close the file
+
+private:
+    struct Frame {
+        G4double start;
+        std::unordered_map<G4int, G4double> pixels; // Pixel index (iy * nx + ix) -> weighted counts
+    };
+
+    void writeFrame(G4long index, const Frame& frame);
+
+    std::map<G4long, Frame> activeFrames;
+    std::ofstream frameFile;
+    G4double frameLength, exposure, fov; // ns, ns, mm
+    G4int nx, ny;
+    G4long framesWritten;
+    G4bool overflowWarned;
+};
+
+#endif
@@ -12,13 +12,19 @@
 #include "G4SDManager.hh"
 #include "G4SubtractionSolid.hh"
 #include "LumaCamMessenger.hh"
+#include "ScintReactionModel.hh"
+#include "QuenchedLightModel.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
 #include "G4PhysicalVolumeStore.hh"
 #include "G4RunManager.hh"
 #include "SimConfig.hh"
+#include <cmath>
 
 GeometryConstructor::GeometryConstructor(ParticleGenerator* gen) 
     : matBuilder(new MaterialBuilder()), eventProc(nullptr), sampleLog(nullptr), scintLog(nullptr), lumaCamMessenger(nullptr),
-      blackSideLog(nullptr), blackBackLog(nullptr) {
+      blackSideLog(nullptr), blackBackLog(nullptr), lShapeLog(nullptr), monitorPhys(nullptr),
+      sampleRotation(new G4RotationMatrix()), sampleAngle(0.) {
     G4cout << "GeometryConstructor: Initializing..." << G4endl;
     matBuilder->DefineMaterials();
     eventProc = new EventProcessor("EventProcessor", gen);
@@ -32,6 +38,7 @@ GeometryConstructor::~GeometryConstructor() {
     G4cout << "GeometryConstructor: Cleaning up..." << G4endl;
     delete matBuilder;
     delete lumaCamMessenger;
+    delete sampleRotation;
     // delete eventProc; // Commented out to avoid double deletion
 }
 
@@ -46,7 +53,7 @@ G4VPhysicalVolume* GeometryConstructor::Construct() {
 
     G4VPhysicalVolume* worldPhys = createWorld();
     G4LogicalVolume* worldLog = worldPhys->GetLogicalVolume();
-    G4LogicalVolume* lShapeLog = buildLShape(worldLog);
+    lShapeLog = buildLShape(worldLog);
 
     // Place sample in world volume
     G4NistManager* nist = G4NistManager::Instance();
@@ -65,8 +72,7 @@ G4VPhysicalVolume* GeometryConstructor::Construct() {
     G4VisAttributes* sampleVisAttributes = new G4VisAttributes(G4Colour(0.15, 0.2, 0.8, 0.5));
     sampleVisAttributes->SetForceSolid(true);
     sampleVisAttributes->SetVisibility(true);
-    new G4PVPlacement(nullptr, G4ThreeVector(-Sim::SCINT_SIZE/2 + Sim::SAMPLE_WIDTH/2, 0, -Sim::SCINT_THICKNESS - Sim::COATING_THICKNESS - Sim::SAMPLE_THICKNESS/2), 
-                      sampleLog, "SamplePhys", worldLog, false, 0, true);
+    new G4PVPlacement(sampleRotation, samplePosition(Sim::SCINT_THICKNESS), sampleLog, "SamplePhys", worldLog, false, 0, true);
     sampleLog->SetVisAttributes(sampleVisAttributes);
 
     // Set sampleLog in LumaCamMessenger
@@ -169,7 +175,7 @@ void GeometryConstructor::UpdateScintillatorGeometry(G4double thickness) {
     // Update sample position to maintain alignment
     G4VPhysicalVolume* samplePhys = physVolStore->GetVolume("SamplePhys", false);
     if (samplePhys) {
-        samplePhys->SetTranslation(G4ThreeVector(0, 0, -thickness - Sim::COATING_THICKNESS - Sim::SAMPLE_THICKNESS/2));
+        samplePhys->SetTranslation(samplePosition(thickness));
         G4cout << "GeometryConstructor: Sample placement updated" << G4endl;
     } else {
         G4cerr << "ERROR: SamplePhys not found in volume store!" << G4endl;
@@ -210,7 +216,7 @@ void GeometryConstructor::UpdateSampleGeometry(G4double thickness, G4Material* m
 
     G4VPhysicalVolume* samplePhys = physVolStore->GetVolume("SamplePhys", false);
     if (samplePhys) {
-        samplePhys->SetTranslation(G4ThreeVector(-Sim::SCINT_SIZE/2 + width/2, 0, -Sim::SCINT_THICKNESS - Sim::COATING_THICKNESS - thickness/2));
+        samplePhys->SetTranslation(samplePosition(Sim::SCINT_THICKNESS));
         G4cout << "GeometryConstructor: Sample placement updated" << G4endl;
     } else {
         G4cerr << "ERROR: SamplePhys not found in volume store!" << G4endl;
@@ -219,6 +225,62 @@ void GeometryConstructor::UpdateSampleGeometry(G4double thickness, G4Material* m
     G4RunManager::GetRunManager()->GeometryHasBeenModified();
 }
 
+void GeometryConstructor::SetMonitorVolumeEnabled(G4bool enabled) {
+    if (!lShapeLog || !monitorPhys) {
+        G4cerr << "ERROR: Monitor volume not constructed!" << G4endl;
+        return;
+    }
+
+    // The placement stays in the volume store so UpdateScintillatorGeometry keeps it aligned
+    G4bool placed = lShapeLog->IsDaughter(monitorPhys);
+    if (enabled && !placed) {
+        lShapeLog->AddDaughter(monitorPhys);
+        G4cout << "GeometryConstructor: MonitorPhys placed" << G4endl;
+    } else if (!enabled && placed) {
+        lShapeLog->RemoveDaughter(monitorPhys);
+        G4cout << "GeometryConstructor: MonitorPhys removed, scoring at scintillator exit face" << G4endl;
+    }
+
+    G4RunManager::GetRunManager()->GeometryHasBeenModified();
+}
+
+void GeometryConstructor::SetSampleRotation(G4double angle) {
+    G4VPhysicalVolume* samplePhys = G4PhysicalVolumeStore::GetInstance()->GetVolume("SamplePhys", false);
+    if (!samplePhys) {
+        G4cerr << "ERROR: SamplePhys not found in volume store!" << G4endl;
+        return;
+    }
+
+    // Placements take the frame rotation, the inverse of the object rotation
+    sampleAngle = angle;
+    *sampleRotation = G4RotationMatrix();
+    sampleRotation->rotateY(-angle);
+    samplePhys->SetRotation(sampleRotation);
+    samplePhys->SetTranslation(samplePosition(Sim::SCINT_THICKNESS));
+    G4cout << "GeometryConstructor: Sample rotated to " << angle/deg << " deg, centre at z = "
+           << samplePhys->GetTranslation().z()/cm << " cm" << G4endl;
+
+    if (samplePhys->CheckOverlaps(1000, 0., false)) {
+        G4Exception("GeometryConstructor::SetSampleRotation()", "GEOM001", FatalException,
+                    "Rotated sample overlaps its neighbours");
+    }
+
+    G4RunManager::GetRunManager()->GeometryHasBeenModified();
+}
+
+// The sample sits on the scintillator's left edge with its downstream face against the coating.
+// Rotated, its corners reach w/2 |sin| + t/2 |cos| downstream of the centre, so the centre moves
+// upstream by that much and the sample never reaches into the L-shape.
+G4ThreeVector GeometryConstructor::samplePosition(G4double scintThickness) const {
+    G4double width = Sim::SAMPLE_WIDTH, thickness = Sim::SAMPLE_THICKNESS;
+    if (G4Box* sampleSolid = sampleLog ? dynamic_cast<G4Box*>(sampleLog->GetSolid()) : nullptr) {
+        width = 2 * sampleSolid->GetXHalfLength();
+        thickness = 2 * sampleSolid->GetZHalfLength();
+    }
+    G4double halfDepth = width/2 * std::abs(std::sin(sampleAngle)) + thickness/2 * std::abs(std::cos(sampleAngle));
+    return G4ThreeVector(-Sim::SCINT_SIZE/2 + width/2, 0, -scintThickness - Sim::COATING_THICKNESS - halfDepth);
+}
+
 G4VPhysicalVolume* GeometryConstructor::createWorld() {
     G4cout << "GeometryConstructor: Creating world volume..." << G4endl;
     G4double worldZSize = std::max(Sim::WORLD_SIZE, Sim::SCINT_THICKNESS + Sim::SAMPLE_THICKNESS + Sim::COATING_THICKNESS + 50*cm);
@@ -289,6 +351,14 @@ void GeometryConstructor::addComponents(G4LogicalVolume* lShapeLog) {
     scintLog->SetVisAttributes(scintVisAttributes);
     scintLog->SetSensitiveDetector(eventProc);
 
+    // Fast reaction and quenched-light models; inactive unless /lumacam/fastScintModels or rangeTableLight is set
+    if (!G4RegionStore::GetInstance()->GetRegion("ScintRegion", false)) {
+        G4Region* scintRegion = new G4Region("ScintRegion");
+        scintRegion->AddRootLogicalVolume(scintLog);
+        new ScintReactionModel("ScintReactionModel", scintRegion);
+        new QuenchedLightModel("QuenchedLightModel", scintRegion);
+    }
+
     G4OpticalSurface* scintSurf = new G4OpticalSurface("ScintSurface");
     scintSurf->SetType(dielectric_dielectric);
     scintSurf->SetFinish(polished);
@@ -382,7 +452,7 @@ void GeometryConstructor::addComponents(G4LogicalVolume* lShapeLog) {
     G4VisAttributes* monitorVisAttributes = new G4VisAttributes(G4Colour(1.0, 0.0, 0.0, 0.5));
     monitorVisAttributes->SetForceSolid(true);
     monitorVisAttributes->SetVisibility(true);
-    new G4PVPlacement(nullptr, G4ThreeVector(0, 0, Sim::SCINT_THICKNESS + 0.5*um), monitorLog, "MonitorPhys", lShapeLog, false, 0, true);
+    monitorPhys = new G4PVPlacement(nullptr, G4ThreeVector(0, 0, Sim::SCINT_THICKNESS + 0.5*um), monitorLog, "MonitorPhys", lShapeLog, false, 0, true);
     monitorLog->SetVisAttributes(monitorVisAttributes);
     monitorLog->SetSensitiveDetector(eventProc);
 
@@ -7,6 +7,7 @@
 #include "ParticleGenerator.hh"
 #include "LumaCamMessenger.hh"
 #include "G4LogicalVolume.hh"
+#include "G4RotationMatrix.hh"
 #include "SimConfig.hh"
 
 class GeometryConstructor : public G4VUserDetectorConstruction {
@@ -17,11 +18,15 @@ public:
     virtual G4VPhysicalVolume* Construct();
     void UpdateScintillatorGeometry(G4double thickness);
     void UpdateSampleGeometry(G4double thickness, G4Material* material, G4double width = Sim::SAMPLE_WIDTH);
+    void SetMonitorVolumeEnabled(G4bool enabled);
+    // Rotate the sample about the vertical (y) axis, keeping its most downstream point against the coating
+    void SetSampleRotation(G4double angle);
 
 private:
     G4VPhysicalVolume* createWorld();
     G4LogicalVolume* buildLShape(G4LogicalVolume* worldLog);
     void addComponents(G4LogicalVolume* lShapeLog);
+    G4ThreeVector samplePosition(G4double scintThickness) const; // SamplePhys centre for the current size and angle
 
     MaterialBuilder* matBuilder;
     EventProcessor* eventProc;
@@ -29,6 +34,10 @@ private:
     G4LogicalVolume* scintLog;
     G4LogicalVolume* blackSideLog; // Added for coating side boxes
     G4LogicalVolume* blackBackLog; // Added for coating back box
+    G4LogicalVolume* lShapeLog;
+    G4VPhysicalVolume* monitorPhys;
+    G4RotationMatrix* sampleRotation; // Owned frame rotation of SamplePhys
+    G4double sampleAngle; // Current rotation about y
     LumaCamMessenger* lumaCamMessenger;
 };
 
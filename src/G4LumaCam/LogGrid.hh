@@ -0,0 +1,34 @@
+#ifndef LOG_GRID_HH
+#define LOG_GRID_HH
+
+#include "G4Types.hh"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Log-spaced energy tables of the fast scintillator models
+namespace LogGrid {
+    constexpr G4int kBinsPerDecade = 40;
+
+    // Grid from emin to emax inclusive
+    inline std::vector<G4double> Make(G4double emin, G4double emax) {
+        G4int bins = std::max(1, static_cast<G4int>(std::ceil(kBinsPerDecade * std::log10(emax / emin))));
+        std::vector<G4double> grid(bins + 1);
+        for (G4int i = 0; i <= bins; ++i) grid[i] = emin * std::pow(emax / emin, static_cast<G4double>(i) / bins);
+        return grid;
+    }
+
+    // Fractional index of energy on Make(emin, emax), clamped to the grid
+    inline G4double Position(G4double energy, G4double emin, G4double emax, std::size_t size) {
+        G4double x = (size - 1) * std::log(energy / emin) / std::log(emax / emin);
+        return std::clamp(x, 0.0, static_cast<G4double>(size - 1));
+    }
+
+    inline G4double Interpolate(const std::vector<G4double>& values, G4double position) {
+        std::size_t i = std::min(static_cast<std::size_t>(position), values.size() - 2);
+        G4double f = position - i;
+        return values[i] + f * (values[i + 1] - values[i]);
+    }
+}
+
+#endif
@@ -1,11 +1,25 @@
 #include "LumaCamMessenger.hh"
 #include "GeometryConstructor.hh"
 #include "SimConfig.hh"
+#include "PerfCounters.hh"
 #include "G4RunManager.hh"
 #include "G4NistManager.hh"
 #include "G4Material.hh"
 #include "G4SystemOfUnits.hh"
 #include "G4UnitsTable.hh"
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+// Parse an "nx ny" pixel grid
+static G4bool parseGrid(const G4String& grid, G4int& nx, G4int& ny) {
+    std::istringstream values(grid);
+    G4int x = 0, y = 0;
+    if (!(values >> x >> y) || x <= 0 || y <= 0) return false;
+    nx = x;
+    ny = y;
+    return true;
+}
 
 LumaCamMessenger::LumaCamMessenger(G4String* filename, G4LogicalVolume* sampleLogVolume, 
                                    G4LogicalVolume* scintLogVolume, G4int batch)
@@ -41,6 +55,20 @@ LumaCamMessenger::LumaCamMessenger(G4String* filename, G4LogicalVolume* sampleLo
         .SetParameterName("material", false)
         .SetDefaultValue("EJ200");
 
+    messenger->DeclareProperty("fastScintModels", Sim::fastScintModels)
+        .SetGuidance("Replace HP transport in the scintillator by its dominant light channel")
+        .SetGuidance("EJ200: n-p elastic recoils (1 keV-20 MeV); GS20: 6Li(n,t)alpha capture (below 10 keV)")
+        .SetGuidance("Charged products emit their quenched light along precomputed ranges instead of being tracked")
+        .SetParameterName("enable", false)
+        .SetDefaultValue("false");
+
+    messenger->DeclareProperty("rangeTableLight", Sim::rangeTableLight)
+        .SetGuidance("Replace EM stepping of protons, tritons and alphas in the scintillator by range tables")
+        .SetGuidance("Birks-quenched light is emitted along a straight CSDA range and the particle is killed")
+        .SetGuidance("Implied by fastScintModels; with HP transport it applies to all recoils and capture products")
+        .SetParameterName("enable", false)
+        .SetDefaultValue("false");
+
     // Scintillator thickness
     messenger->DeclareMethod("scintThickness", &LumaCamMessenger::SetScintThickness)
         .SetGuidance("Set the scintillator thickness in cm")
@@ -88,10 +116,262 @@ LumaCamMessenger::LumaCamMessenger(G4String* filename, G4LogicalVolume* sampleLo
         .SetGuidance("Set pulse frequency in Hz")
         .SetParameterName("freq", false)
         .SetDefaultValue("0.0");
+
+    // Per-photon CSV output
+    messenger->DeclareProperty("photonOutput", Sim::writePhotons)
+        .SetGuidance("Write per-photon CSV files to SimPhotons (disable when only accumulated output is needed)")
+        .SetParameterName("enable", false)
+        .SetDefaultValue("true");
+
+    messenger->DeclareProperty("lensAcceptance", Sim::lensAcceptance)
+        .SetGuidance("Record only photons heading into the lens window (disable to keep every escaping photon)")
+        .SetParameterName("enable", false)
+        .SetDefaultValue("true");
+
+    messenger->DeclareMethod("photonFormat", &LumaCamMessenger::SetPhotonFormat)
+        .SetGuidance("Set the per-photon file format (csv or binary)")
+        .SetGuidance("binary: quantized .lcph files with a round-trip error report at the end of each run")
+        .SetParameterName("format", false)
+        .SetCandidates("csv binary")
+        .SetDefaultValue("csv");
+
+    messenger->DeclarePropertyWithUnit("codecPositionGrid", "um", Sim::CODEC_POSITION_GRID)
+        .SetGuidance("Set the position grid of binary photon output (error bound is half the grid)")
+        .SetParameterName("grid", false)
+        .SetDefaultValue("1.0");
+
+    messenger->DeclarePropertyWithUnit("codecTimeTick", "ns", Sim::CODEC_TIME_TICK)
+        .SetGuidance("Set the time tick of binary photon output (error bound is half the tick)")
+        .SetParameterName("tick", false)
+        .SetDefaultValue("0.001");
+
+    messenger->DeclareProperty("codecBlockPhotons", Sim::CODEC_BLOCK_PHOTONS)
+        .SetGuidance("Set the photons per block of binary photon output")
+        .SetGuidance("Each block carries ID/time/energy min/max statistics that readers use to skip it")
+        .SetParameterName("photons", false)
+        .SetDefaultValue("65536");
+
+    messenger->DeclarePropertyWithUnit("codecTileSize", "mm", Sim::CODEC_TILE_SIZE)
+        .SetGuidance("Bucket binary photon blocks into square x/y tiles of this width (0 disables tiling)")
+        .SetGuidance("Blocks carry x/y bounds, so region-of-interest reads skip tiles outside the region")
+        .SetParameterName("size", false)
+        .SetDefaultValue("0");
+
+    // Prescaled photon detail with per-neutron summaries
+    messenger->DeclareMethod("detailPrescale", &LumaCamMessenger::SetDetailPrescale)
+        .SetGuidance("Write photon records for a reproducible 1-in-K subset of events (selected by event ID hash)")
+        .SetGuidance("Online accumulators still see every event; K is recorded in the run manifest")
+        .SetParameterName("K", false)
+        .SetDefaultValue("1");
+
+    messenger->DeclareProperty("neutronSummary", Sim::neutronSummary)
+        .SetGuidance("Write one summary row per event to SimNeutrons (photon count, weight, centroid, first toa)")
+        .SetParameterName("enable", false)
+        .SetDefaultValue("true");
+
+    // Batch completion notifications for pipelined consumers
+    messenger->DeclareProperty("notifyFile", Sim::notifyFile)
+        .SetGuidance("Append one JSON line per closed photon batch file (path, rows, neutron ID range)")
+        .SetGuidance("and a run_end line per run; a FIFO or /dev/fd/N can be used as the channel")
+        .SetParameterName("filename", false);
+
+    // Escaping photon scoring
+    messenger->DeclareMethod("monitorMode", &LumaCamMessenger::SetMonitorMode)
+        .SetGuidance("Set how escaping photons are scored (volume or exitFace)")
+        .SetGuidance("volume: record in the MonitorPhys air layer above the scintillator")
+        .SetGuidance("exitFace: record from the OpBoundary status at the scintillator top face, without MonitorPhys")
+        .SetParameterName("mode", false)
+        .SetCandidates("volume exitFace")
+        .SetDefaultValue("volume");
+
+    messenger->DeclareProperty("opticalFastPath", Sim::opticalFastPath)
+        .SetGuidance("Resolve hits on trivial optical surfaces without the generic boundary model (off, on or check)")
+        .SetGuidance("on: kill at zero-reflectivity absorbers, pass straight through R=0/T=1 polished dielectric skins")
+        .SetGuidance("check: run G4OpBoundaryProcess and count hits whose outcome differs from the shortcut")
+        .SetParameterName("mode", false)
+        .SetCandidates("off on check")
+        .SetDefaultValue("off");
+
+    // Hardware performance counters per run phase
+    messenger->DeclareMethod("perfCounters", &LumaCamMessenger::SetPerfCounters)
+        .SetGuidance("Sample cycles, instructions, cache and branch misses per phase (init, event_loop, sd, output)")
+        .SetGuidance("Reported in the run summary and SimPerf; falls back to phase times without perf_event_open")
+        .SetParameterName("enable", false)
+        .SetDefaultValue("true");
+
+    // Source importance sampling
+    messenger->DeclareMethod("importanceMode", &LumaCamMessenger::SetImportanceMode)
+        .SetGuidance("Set source importance sampling mode (none, map, or edge)")
+        .SetGuidance("Sampled positions carry a compensating weight in the output")
+        .SetParameterName("mode", false)
+        .SetCandidates("none map edge")
+        .SetDefaultValue("none");
+
+    messenger->DeclareProperty("importanceMap", Sim::importanceMapFile)
+        .SetGuidance("Set the importance map file (nx ny, then ny rows of nx values over the GPS plane)")
+        .SetParameterName("filename", false);
+
+    messenger->DeclarePropertyWithUnit("importanceEdgeWidth", "mm", Sim::IMPORTANCE_EDGE_WIDTH)
+        .SetGuidance("Set the half-width of the boosted band around the sample edge")
+        .SetParameterName("width", false)
+        .SetDefaultValue("2.0");
+
+    messenger->DeclareProperty("importanceEdgeBoost", Sim::IMPORTANCE_EDGE_BOOST)
+        .SetGuidance("Set the relative importance of the sample edge band")
+        .SetParameterName("boost", false)
+        .SetDefaultValue("10.0");
+
+    // Spectrum reweighting of the online accumulators
+    messenger->DeclareProperty("reweightFile", Sim::reweightFile)
+        .SetGuidance("Set the spectrum reweight table (energy in MeV and target/sampling weight per row)")
+        .SetGuidance("Frames and TOF cube are filled with this per-neutron weight; photon records are unchanged")
+        .SetGuidance("Neutrons outside the table get weight 0")
+        .SetParameterName("filename", false);
+
+    // Sparse per-exposure frames for frame-based cameras
+    frameMessenger = new G4GenericMessenger(this, "/lumacam/frames/", "Sparse per-exposure frame output");
+
+    frameMessenger->DeclareProperty("enable", Sim::frameOutput)
+        .SetGuidance("Accumulate detected photons into sparse frames written to SimFrames")
+        .SetParameterName("enable", false)
+        .SetDefaultValue("true");
+
+    frameMessenger->DeclareMethod("grid", &LumaCamMessenger::SetFrameGrid)
+        .SetGuidance("Set the frame pixel grid as 'nx ny'")
+        .SetParameterName("grid", false)
+        .SetDefaultValue("512 512");
+
+    frameMessenger->DeclarePropertyWithUnit("fov", "mm", Sim::FRAME_FOV)
+        .SetGuidance("Set the frame field of view on the scintillator exit face (0 for the scintillator size)")
+        .SetParameterName("fov", false)
+        .SetDefaultValue("0.0");
+
+    frameMessenger->DeclareMethod("pulsesPerFrame", &LumaCamMessenger::SetFramePulses)
+        .SetGuidance("Set the number of pulse periods integrated into each frame")
+        .SetParameterName("pulses", false)
+        .SetDefaultValue("1");
+
+    frameMessenger->DeclarePropertyWithUnit("exposure", "ns", Sim::FRAME_EXPOSURE)
+        .SetGuidance("Set the exposure from frame start; the rest of the frame period is readout")
+        .SetGuidance("Without a pulsed beam this is also the frame period. 0 exposes the whole period.")
+        .SetParameterName("exposure", false)
+        .SetDefaultValue("0.0");
+
+    frameMessenger->DeclareMethod("maxActive", &LumaCamMessenger::SetFrameMaxActive)
+        .SetGuidance("Set the number of open frames kept in memory")
+        .SetParameterName("count", false)
+        .SetDefaultValue("64");
+
+    // Online (x, y, TOF) cube for energy-resolved imaging
+    tofCubeMessenger = new G4GenericMessenger(this, "/lumacam/tofCube/", "Online TOF-resolved image stack");
+
+    tofCubeMessenger->DeclareProperty("enable", Sim::tofCubeOutput)
+        .SetGuidance("Accumulate an (x, y, toa - pulse time) cube written to SimTOF at the end of the run")
+        .SetParameterName("enable", false)
+        .SetDefaultValue("true");
+
+    tofCubeMessenger->DeclareMethod("grid", &LumaCamMessenger::SetTofCubeGrid)
+        .SetGuidance("Set the cube pixel grid as 'nx ny'")
+        .SetParameterName("grid", false)
+        .SetDefaultValue("256 256");
+
+    tofCubeMessenger->DeclarePropertyWithUnit("fov", "mm", Sim::TOF_CUBE_FOV)
+        .SetGuidance("Set the cube field of view on the scintillator exit face (0 for the scintillator size)")
+        .SetParameterName("fov", false)
+        .SetDefaultValue("0.0");
+
+    tofCubeMessenger->DeclareMethod("bins", &LumaCamMessenger::SetTofCubeBins)
+        .SetGuidance("Set the number of TOF bins")
+        .SetParameterName("bins", false)
+        .SetDefaultValue("1000");
+
+    tofCubeMessenger->DeclarePropertyWithUnit("tofMin", "ns", Sim::TOF_CUBE_MIN)
+        .SetGuidance("Set the lower TOF edge (must be positive for log bins)")
+        .SetParameterName("tof", false)
+        .SetDefaultValue("1000.0");
+
+    tofCubeMessenger->DeclarePropertyWithUnit("tofMax", "ns", Sim::TOF_CUBE_MAX)
+        .SetGuidance("Set the upper TOF edge")
+        .SetParameterName("tof", false)
+        .SetDefaultValue("5e7");
+
+    tofCubeMessenger->DeclareProperty("logBins", Sim::TOF_CUBE_LOG)
+        .SetGuidance("Use log-spaced TOF bins")
+        .SetParameterName("log", false)
+        .SetDefaultValue("true");
+
+    // Tomography: rotate the sample between sub-runs of one process
+    tomoMessenger = new G4GenericMessenger(this, "/lumacam/tomo/", "Tomography angle scans");
+
+    tomoMessenger->DeclareMethod("angles", &LumaCamMessenger::SetTomoAngles)
+        .SetGuidance("Set n projection angles in degrees, evenly spaced from start up to (excluding) stop")
+        .SetGuidance("The sample rotates about the vertical (y) axis through its centre")
+        .SetGuidance("and moves upstream so its most downstream point stays against the scintillator coating")
+        .SetParameterName("start stop n", false)
+        .SetDefaultValue("0 180 180");
+
+    tomoMessenger->DeclareMethod("worker", &LumaCamMessenger::SetTomoWorker)
+        .SetGuidance("Run only angles with index % count == index, to spread a scan over processes")
+        .SetParameterName("index count", false)
+        .SetDefaultValue("0 1");
+
+    tomoMessenger->DeclareMethod("beamOn", &LumaCamMessenger::RunTomography)
+        .SetGuidance("Run this many events at each angle of this worker")
+        .SetGuidance("Each angle writes its outputs under <base>_angle<k>; SimTomo indexes the angles")
+        .SetParameterName("events", false);
+
+    // Neutron termination (thresholds of 0 are disabled)
+    killMessenger = new G4GenericMessenger(this, "/lumacam/neutronKill/", "Neutron termination thresholds");
+
+    killMessenger->DeclarePropertyWithUnit("sampleEnergy", "eV", Sim::SAMPLE_KILL_ENERGY)
+        .SetGuidance("Kill neutrons in the sample below this kinetic energy")
+        .SetParameterName("energy", false)
+        .SetDefaultValue("0.0");
+
+    killMessenger->DeclarePropertyWithUnit("sampleTime", "ns", Sim::SAMPLE_KILL_TIME)
+        .SetGuidance("Kill neutrons in the sample this long after the event trigger (pulse time)")
+        .SetParameterName("time", false)
+        .SetDefaultValue("0.0");
+
+    killMessenger->DeclarePropertyWithUnit("scintEnergy", "eV", Sim::SCINT_KILL_ENERGY)
+        .SetGuidance("Kill neutrons in the scintillator below this kinetic energy")
+        .SetGuidance("Leave at 0 for GS20, where light comes from thermal capture")
+        .SetParameterName("energy", false)
+        .SetDefaultValue("0.0");
+
+    killMessenger->DeclarePropertyWithUnit("scintTime", "ns", Sim::SCINT_KILL_TIME)
+        .SetGuidance("Kill neutrons in the scintillator this long after the event trigger (pulse time)")
+        .SetParameterName("time", false)
+        .SetDefaultValue("0.0");
+
+    killMessenger->DeclarePropertyWithUnit("housingEnergy", "eV", Sim::HOUSING_KILL_ENERGY)
+        .SetGuidance("Kill neutrons outside sample and scintillator below this kinetic energy")
+        .SetParameterName("energy", false)
+        .SetDefaultValue("0.0");
+
+    killMessenger->DeclarePropertyWithUnit("housingTime", "ns", Sim::HOUSING_KILL_TIME)
+        .SetGuidance("Kill neutrons outside sample and scintillator this long after the event trigger (pulse time)")
+        .SetParameterName("time", false)
+        .SetDefaultValue("0.0");
+
+    killMessenger->DeclareMethod("maxScatters", &LumaCamMessenger::SetNeutronMaxScatters)
+        .SetGuidance("Kill neutrons after this many interactions (0 for no limit)")
+        .SetParameterName("count", false)
+        .SetDefaultValue("0");
+
+    killMessenger->DeclareMethod("rouletteSurvival", &LumaCamMessenger::SetNeutronRouletteSurvival)
+        .SetGuidance("Russian roulette survival probability per interaction outside the scintillator")
+        .SetGuidance("Survivors carry weight 1/p in the output; 1 disables roulette")
+        .SetParameterName("probability", false)
+        .SetDefaultValue("1.0");
 }
 
 LumaCamMessenger::~LumaCamMessenger() {
     delete messenger;
+    delete killMessenger;
+    delete frameMessenger;
+    delete tofCubeMessenger;
+    delete tomoMessenger;
     delete matBuilder;
 }
 
@@ -251,4 +531,189 @@ void LumaCamMessenger::SetFrequency(G4double freq) {
     }
     Sim::FREQ = freq;
     G4cout << "Pulse frequency set to: " << freq / 1000 << " kHz" << G4endl;
+}
+
+void LumaCamMessenger::SetMonitorMode(const G4String& mode) {
+    if (mode != "volume" && mode != "exitFace") {
+        G4cerr << "ERROR: Monitor mode must be volume or exitFace!" << G4endl;
+        return;
+    }
+    GeometryConstructor* geom = dynamic_cast<GeometryConstructor*>(
+        const_cast<G4VUserDetectorConstruction*>(
+            G4RunManager::GetRunManager()->GetUserDetectorConstruction()));
+    if (!geom) {
+        G4cerr << "ERROR: Failed to cast to GeometryConstructor!" << G4endl;
+        return;
+    }
+    Sim::monitorMode = mode;
+    geom->SetMonitorVolumeEnabled(mode == "volume");
+    G4cout << "Monitor mode set to: " << mode << G4endl;
+}
+
+void LumaCamMessenger::SetPhotonFormat(const G4String& format) {
+    if (format != "csv" && format != "binary") {
+        G4cerr << "ERROR: Photon format must be csv or binary!" << G4endl;
+        return;
+    }
+    Sim::photonFormat = format;
+    G4cout << "Photon format set to: " << format << G4endl;
+}
+
+void LumaCamMessenger::SetDetailPrescale(G4int prescale) {
+    if (prescale < 1) {
+        G4cerr << "ERROR: Detail prescale must be at least 1!" << G4endl;
+        return;
+    }
+    Sim::DETAIL_PRESCALE = prescale;
+    G4cout << "Photon detail prescale set to: 1 in " << prescale << " events" << G4endl;
+}
+
+void LumaCamMessenger::SetFrameGrid(const G4String& grid) {
+    if (!parseGrid(grid, Sim::FRAME_NX, Sim::FRAME_NY)) {
+        G4cerr << "ERROR: Frame grid must be two positive integers 'nx ny'!" << G4endl;
+        return;
+    }
+    G4cout << "Frame grid set to: " << Sim::FRAME_NX << " x " << Sim::FRAME_NY << G4endl;
+}
+
+void LumaCamMessenger::SetFramePulses(G4int pulses) {
+    if (pulses <= 0) {
+        G4cerr << "ERROR: Pulses per frame must be positive!" << G4endl;
+        return;
+    }
+    Sim::FRAME_PULSES = pulses;
+    G4cout << "Pulses per frame set to: " << pulses << G4endl;
+}
+
+void LumaCamMessenger::SetFrameMaxActive(G4int count) {
+    if (count < 1) {
+        G4cerr << "ERROR: Maximum number of open frames must be at least 1!" << G4endl;
+        return;
+    }
+    Sim::FRAME_MAX_ACTIVE = count;
+    G4cout << "Maximum open frames set to: " << count << G4endl;
+}
+
+void LumaCamMessenger::SetTofCubeGrid(const G4String& grid) {
+    if (!parseGrid(grid, Sim::TOF_CUBE_NX, Sim::TOF_CUBE_NY)) {
+        G4cerr << "ERROR: TOF cube grid must be two positive integers 'nx ny'!" << G4endl;
+        return;
+    }
+    G4cout << "TOF cube grid set to: " << Sim::TOF_CUBE_NX << " x " << Sim::TOF_CUBE_NY << G4endl;
+}
+
+void LumaCamMessenger::SetTofCubeBins(G4int bins) {
+    if (bins <= 0) {
+        G4cerr << "ERROR: TOF cube bins must be positive!" << G4endl;
+        return;
+    }
+    Sim::TOF_CUBE_BINS = bins;
+    G4cout << "TOF cube bins set to: " << bins << G4endl;
+}
+
+void LumaCamMessenger::SetTomoAngles(const G4String& angles) {
+    std::istringstream values(angles);
+    G4double start = 0, stop = 0;
+    G4int count = 0;
+    if (!(values >> start >> stop >> count) || count <= 0) {
+        G4cerr << "ERROR: Tomography angles must be 'start stop n' in degrees with n > 0!" << G4endl;
+        return;
+    }
+    Sim::tomoAngles.clear();
+    for (G4int k = 0; k < count; ++k) {
+        Sim::tomoAngles.push_back((start + (stop - start) * k / count) * deg);
+    }
+    G4cout << "Tomography angles set to: " << count << " from " << start << " to " << stop << " deg" << G4endl;
+}
+
+void LumaCamMessenger::SetTomoWorker(const G4String& worker) {
+    std::istringstream values(worker);
+    G4int index = -1, count = 0;
+    if (!(values >> index >> count) || count <= 0 || index < 0 || index >= count) {
+        G4cerr << "ERROR: Tomography worker must be 'index count' with 0 <= index < count!" << G4endl;
+        return;
+    }
+    Sim::TOMO_WORKER_INDEX = index;
+    Sim::TOMO_WORKER_COUNT = count;
+    G4cout << "Tomography worker set to: " << index << " of " << count << G4endl;
+}
+
+void LumaCamMessenger::RunTomography(G4int eventsPerAngle) {
+    if (Sim::tomoAngles.empty()) {
+        G4cerr << "ERROR: Set /lumacam/tomo/angles before /lumacam/tomo/beamOn!" << G4endl;
+        return;
+    }
+    if (eventsPerAngle <= 0) {
+        G4cerr << "ERROR: Events per angle must be positive!" << G4endl;
+        return;
+    }
+    GeometryConstructor* geom = dynamic_cast<GeometryConstructor*>(
+        const_cast<G4VUserDetectorConstruction*>(
+            G4RunManager::GetRunManager()->GetUserDetectorConstruction()));
+    if (!geom) {
+        G4cerr << "ERROR: Failed to cast to GeometryConstructor!" << G4endl;
+        return;
+    }
+
+    // Sub-runs write every per-run output under their own base name
+    G4String baseFile = Sim::outputFileName;
+    G4String baseName = Sim::OutputBaseName();
+    std::filesystem::path indexPath = Sim::OutputDirectory("SimTomo") /
+        (baseName + "_angles_" + std::to_string(Sim::TOMO_WORKER_INDEX) + ".csv");
+    std::ofstream index(indexPath);
+    if (!index.is_open()) {
+        G4cerr << "ERROR: Failed to open tomography index: " << indexPath << G4endl;
+        return;
+    }
+    index << "angle_index,angle_deg,base_name\n";
+
+    for (size_t k = 0; k < Sim::tomoAngles.size(); ++k) {
+        if (static_cast<G4int>(k % Sim::TOMO_WORKER_COUNT) != Sim::TOMO_WORKER_INDEX) continue;
+        std::ostringstream angleName;
+        angleName << baseName << "_angle" << std::setw(4) << std::setfill('0') << k;
+        G4cout << "\n=== Tomography angle " << k + 1 << "/" << Sim::tomoAngles.size() << ": "
+               << Sim::tomoAngles[k]/deg << " deg ===" << G4endl;
+
+        geom->SetSampleRotation(Sim::tomoAngles[k]);
+        Sim::outputFileName = angleName.str() + ".csv";
+        G4RunManager::GetRunManager()->BeamOn(eventsPerAngle);
+        index << k << "," << Sim::tomoAngles[k]/deg << "," << angleName.str() << "\n";
+        index.flush();
+    }
+
+    Sim::outputFileName = baseFile;
+    geom->SetSampleRotation(0.);
+    G4cout << "Tomography index written to " << indexPath << G4endl;
+}
+
+void LumaCamMessenger::SetPerfCounters(G4bool enable) {
+    PerfCounters::Instance().Enable(enable);
+    G4cout << "Performance counters " << (enable ? "enabled" : "disabled") << G4endl;
+}
+
+void LumaCamMessenger::SetImportanceMode(const G4String& mode) {
+    if (mode != "none" && mode != "map" && mode != "edge") {
+        G4cerr << "ERROR: Importance mode must be none, map, or edge!" << G4endl;
+        return;
+    }
+    Sim::importanceMode = mode;
+    G4cout << "Source importance sampling set to: " << mode << G4endl;
+}
+
+void LumaCamMessenger::SetNeutronMaxScatters(G4int count) {
+    if (count < 0) {
+        G4cerr << "ERROR: Neutron max scatters must be non-negative!" << G4endl;
+        return;
+    }
+    Sim::NEUTRON_MAX_SCATTERS = count;
+    G4cout << "Neutron max scatters set to: " << count << G4endl;
+}
+
+void LumaCamMessenger::SetNeutronRouletteSurvival(G4double probability) {
+    if (probability <= 0 || probability > 1) {
+        G4cerr << "ERROR: Roulette survival probability must be in (0, 1]!" << G4endl;
+        return;
+    }
+    Sim::NEUTRON_ROULETTE_SURVIVAL = probability;
+    G4cout << "Neutron roulette survival probability set to: " << probability << G4endl;
 }
\ No newline at end of file
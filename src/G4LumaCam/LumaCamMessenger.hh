@@ -23,6 +23,21 @@ public:
     void SetFlux(G4double flux);
     void SetFrequency(G4double freq);
     void SetBatchSize(G4int size);
+    void SetMonitorMode(const G4String& mode);
+    void SetPhotonFormat(const G4String& format);
+    void SetDetailPrescale(G4int prescale);
+    void SetFrameGrid(const G4String& grid);
+    void SetFramePulses(G4int pulses);
+    void SetFrameMaxActive(G4int count);
+    void SetTofCubeGrid(const G4String& grid);
+    void SetTofCubeBins(G4int bins);
+    void SetTomoAngles(const G4String& angles);
+    void SetTomoWorker(const G4String& worker);
+    void RunTomography(G4int eventsPerAngle);
+    void SetPerfCounters(G4bool enable);
+    void SetImportanceMode(const G4String& mode);
+    void SetNeutronMaxScatters(G4int count);
+    void SetNeutronRouletteSurvival(G4double probability);
     void SetSampleLog(G4LogicalVolume* log);
     void SetScintLog(G4LogicalVolume* log);
 
@@ -32,6 +47,10 @@ private:
     G4LogicalVolume* scintLog;
     G4int batchSize;
     G4GenericMessenger* messenger;
+    G4GenericMessenger* killMessenger;
+    G4GenericMessenger* frameMessenger;
+    G4GenericMessenger* tofCubeMessenger;
+    G4GenericMessenger* tomoMessenger;
     MaterialBuilder* matBuilder;
 };
 
@@ -315,4 +315,19 @@ void MaterialBuilder::setScintillatorType(const G4String& typeName) {
     } else {
         G4cerr << "ERROR: Unknown scintillator type: " << typeName << ". Available types: EJ200, GS20, LYSO, ScintillatorPVT, ScintillatorGS20, ScintillatorLYSO" << G4endl;
     }
-}
\ No newline at end of file
+}
+
+G4bool MaterialBuilder::scintTypeOf(const G4Material* material, ScintType& type) {
+    if (!material) return false;
+    const G4String& name = material->GetName();
+    if (name == "ScintillatorPVT") {
+        type = ScintType::EJ200;
+    } else if (name == "ScintillatorGS20") {
+        type = ScintType::GS20;
+    } else if (name == "ScintillatorLYSO") {
+        type = ScintType::LYSO;
+    } else {
+        return false;
+    }
+    return true;
+}
@@ -26,6 +26,7 @@ public:
 
     void setScintillatorType(ScintType type);
     void setScintillatorType(const G4String& typeName);
+    static G4bool scintTypeOf(const G4Material* material, ScintType& type); // False for non-scintillators
 
 private:
     void setupMaterialProperties(G4Material* mat, const G4double* energies,
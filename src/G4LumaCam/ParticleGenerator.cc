@@ -1,12 +1,20 @@
 #include "ParticleGenerator.hh"
 #include "SimConfig.hh"
 #include "G4Neutron.hh"
+#include "G4Event.hh"
+#include "G4PrimaryVertex.hh"
 #include "G4SystemOfUnits.hh"
 #include "Randomize.hh"
+#include "G4SPSPosDistribution.hh"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
 
 ParticleGenerator::ParticleGenerator()
     : source(new G4GeneralParticleSource()), lastEnergy(0.), 
-      currentPulseIndex(0), neutronsInCurrentPulse(0) {
+      currentPulseIndex(0), neutronsInCurrentPulse(0), eventWeight(1.0),
+      mapNx(0), mapNy(0), mapCentreX(0.), mapCentreY(0.), mapHalfX(0.), mapHalfY(0.) {
     source->SetParticleDefinition(G4Neutron::NeutronDefinition());
 }
 
@@ -84,9 +92,153 @@ void ParticleGenerator::GeneratePrimaries(G4Event* anEvent) {
         anEvent->GetPrimaryVertex()->SetT0(0.0 * ns);
     }
     
+    eventWeight = 1.0;
+    if (!importanceCdf.empty()) {
+        sampleImportancePosition(anEvent);
+    }
+    
     lastEnergy = source->GetParticleEnergy() / MeV;
     if (lastEnergy <= 0) {
         G4cerr << "WARNING: Generated neutron energy is " << lastEnergy << " MeV for event " 
                << anEvent->GetEventID() << G4endl;
     }
+}
+
+void ParticleGenerator::PrepareImportanceSampling() {
+    importance.clear();
+    importanceCdf.clear();
+    mapNx = mapNy = 0;
+
+    if (!Sim::ImportanceSamplingEnabled()) {
+        if (Sim::importanceMode != "none") {
+            G4cerr << "WARNING: Unknown importance mode '" << Sim::importanceMode
+                   << "', sampling the source uniformly" << G4endl;
+        }
+        return;
+    }
+
+    // The map spans the GPS rectangle, which is assumed to be an unrotated plane normal to z
+    G4SPSPosDistribution* posDist = source->GetCurrentSource()->GetPosDist();
+    mapCentreX = posDist->GetCentreCoords().x();
+    mapCentreY = posDist->GetCentreCoords().y();
+    mapHalfX = posDist->GetHalfX();
+    mapHalfY = posDist->GetHalfY();
+    if (mapHalfX <= 0 || mapHalfY <= 0) {
+        G4cerr << "ERROR: Importance sampling needs a rectangular GPS plane with positive halfx/halfy" << G4endl;
+        return;
+    }
+
+    if (Sim::importanceMode == "map") {
+        if (!loadImportanceMap(Sim::importanceMapFile)) {
+            importance.clear();
+            return;
+        }
+    } else {
+        buildEdgeImportanceMap();
+    }
+
+    G4double total = 0.;
+    importanceCdf.reserve(importance.size());
+    for (G4double value : importance) {
+        total += std::max(0., value);
+        importanceCdf.push_back(total);
+    }
+    if (total <= 0) {
+        G4cerr << "ERROR: Importance map has no positive entries, sampling the source uniformly" << G4endl;
+        importance.clear();
+        importanceCdf.clear();
+        return;
+    }
+
+    G4int emptyBins = 0;
+    G4double minImportance = 0., maxImportance = 0.;
+    for (G4double value : importance) {
+        if (value <= 0) {
+            emptyBins++;
+            continue;
+        }
+        minImportance = (minImportance > 0) ? std::min(minImportance, value) : value;
+        maxImportance = std::max(maxImportance, value);
+    }
+    G4double meanImportance = total / importance.size();
+
+    G4cout << "\n=== Source Importance Sampling ===" << G4endl;
+    G4cout << "Mode: " << Sim::importanceMode << G4endl;
+    G4cout << "Map: " << mapNx << " x " << mapNy << " bins over "
+           << 2 * mapHalfX / mm << " x " << 2 * mapHalfY / mm << " mm" << G4endl;
+    G4cout << "Weight range: " << meanImportance / maxImportance
+           << " - " << meanImportance / minImportance << G4endl;
+    if (emptyBins > 0) {
+        G4cout << "WARNING: " << emptyBins << " bins have zero importance and are never sampled" << G4endl;
+    }
+    G4cout << "==================================" << G4endl;
+}
+
+G4bool ParticleGenerator::loadImportanceMap(const G4String& fileName) {
+    std::ifstream mapFile(fileName);
+    if (!mapFile.is_open()) {
+        G4cerr << "ERROR: Cannot open importance map " << fileName << G4endl;
+        return false;
+    }
+
+    // Format: '#' comments, then "nx ny", then ny rows of nx values from -halfy to +halfy
+    std::stringstream values;
+    std::string line;
+    while (std::getline(mapFile, line)) {
+        size_t hashPos = line.find('#');
+        if (hashPos != std::string::npos) line = line.substr(0, hashPos);
+        std::replace(line.begin(), line.end(), ',', ' ');
+        values << line << ' ';
+    }
+
+    if (!(values >> mapNx >> mapNy) || mapNx <= 0 || mapNy <= 0) {
+        G4cerr << "ERROR: Importance map " << fileName << " must start with positive 'nx ny'" << G4endl;
+        return false;
+    }
+
+    importance.resize(static_cast<size_t>(mapNx) * mapNy);
+    for (G4double& value : importance) {
+        if (!(values >> value)) {
+            G4cerr << "ERROR: Importance map " << fileName << " has fewer than "
+                   << mapNx * mapNy << " values" << G4endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+void ParticleGenerator::buildEdgeImportanceMap() {
+    // Boost a band around the sample edge, which sits at the +x side of the sample
+    G4double edgeX = -Sim::SCINT_SIZE/2 + Sim::SAMPLE_WIDTH;
+    G4double binWidth = std::max(Sim::IMPORTANCE_EDGE_WIDTH / 4, 1 * um);
+    mapNx = std::clamp(static_cast<G4int>(std::ceil(2 * mapHalfX / binWidth)), 1, 4096);
+    mapNy = 1;
+
+    importance.assign(mapNx, 1.0);
+    for (G4int ix = 0; ix < mapNx; ++ix) {
+        G4double x = mapCentreX - mapHalfX + (ix + 0.5) * 2 * mapHalfX / mapNx;
+        if (std::abs(x - edgeX) <= Sim::IMPORTANCE_EDGE_WIDTH) {
+            importance[ix] = Sim::IMPORTANCE_EDGE_BOOST;
+        }
+    }
+}
+
+void ParticleGenerator::sampleImportancePosition(G4Event* anEvent) {
+    G4PrimaryVertex* vertex = anEvent->GetPrimaryVertex();
+    if (!vertex) return;
+
+    G4double total = importanceCdf.back();
+    size_t bin = std::upper_bound(importanceCdf.begin(), importanceCdf.end(),
+                                  G4UniformRand() * total) - importanceCdf.begin();
+    bin = std::min(bin, importanceCdf.size() - 1);
+    G4int ix = bin % mapNx;
+    G4int iy = bin / mapNx;
+
+    G4double x = mapCentreX - mapHalfX + (ix + G4UniformRand()) * 2 * mapHalfX / mapNx;
+    G4double y = mapCentreY - mapHalfY + (iy + G4UniformRand()) * 2 * mapHalfY / mapNy;
+    vertex->SetPosition(x, y, vertex->GetZ0());
+
+    // Uniform pdf over equal-area bins divided by the sampled pdf
+    eventWeight = total / (importance.size() * importance[bin]);
+    vertex->SetWeight(eventWeight);
 }
\ No newline at end of file
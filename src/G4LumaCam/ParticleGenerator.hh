@@ -3,6 +3,7 @@
 
 #include "G4VUserPrimaryGeneratorAction.hh"
 #include "G4GeneralParticleSource.hh"
+#include <vector>
 
 class ParticleGenerator : public G4VUserPrimaryGeneratorAction {
 public:
@@ -13,12 +14,25 @@ public:
     G4double getParticleEnergy() const { return lastEnergy; }
     void SetTotalNeutrons(G4int totalNeutrons);
     G4int getCurrentPulseIndex() const { return currentPulseIndex; } 
+    G4double getEventWeight() const { return eventWeight; }
+    void PrepareImportanceSampling(); // Build the importance map for the current GPS plane and geometry
 
 private:
+    G4bool loadImportanceMap(const G4String& fileName);
+    void buildEdgeImportanceMap();
+    void sampleImportancePosition(G4Event* anEvent);
+
     G4GeneralParticleSource* source;
     G4double lastEnergy;
     G4int currentPulseIndex;
     G4int neutronsInCurrentPulse;
+    G4double eventWeight;
+
+    // Importance map over the source plane, row-major with row 0 at -halfy
+    std::vector<G4double> importance;
+    std::vector<G4double> importanceCdf;
+    G4int mapNx, mapNy;
+    G4double mapCentreX, mapCentreY, mapHalfX, mapHalfY;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,289 @@
+#include "PerfCounters.hh"
+#include "SimConfig.hh"
+#include "G4ios.hh"
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    const char* kPhaseNames[PerfCounters::kNumPhases] = {"init", "event_loop", "sd", "output"};
+    const char* kCounterNames[PerfCounters::kNumCounters] = {"cycles", "instructions", "cache_misses", "branch_misses"};
+
+    G4double now() {
+        return std::chrono::duration<G4double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+#ifdef __linux__
+    const uint64_t kCounterConfigs[PerfCounters::kNumCounters] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+#if defined(__x86_64__) || defined(__i386__)
+    inline uint64_t rdpmc(uint32_t counter) {
+        uint32_t low, high;
+        __asm__ volatile("rdpmc" : "=a"(low), "=d"(high) : "c"(counter));
+        return static_cast<uint64_t>(high) << 32 | low;
+    }
+
+    // Lock-free user-space read following the perf_event_mmap_page protocol
+    G4bool readMapped(const perf_event_mmap_page* page, uint64_t& value) {
+        uint32_t seq;
+        do {
+            seq = page->lock;
+            __asm__ volatile("" ::: "memory");
+            uint32_t index = page->index;
+            if (!page->cap_user_rdpmc || index == 0) return false; // Not scheduled on a PMU counter
+            int64_t count = rdpmc(index - 1);
+            uint16_t width = page->pmc_width;
+            count <<= 64 - width;
+            count >>= 64 - width;
+            value = page->offset + count;
+            __asm__ volatile("" ::: "memory");
+        } while (page->lock != seq);
+        return true;
+    }
+#else
+    G4bool readMapped(const perf_event_mmap_page*, uint64_t&) { return false; }
+#endif
+#endif
+}
+
+PerfCounters::Scope::Scope(Phase phase, G4bool fineGrained) {
+    PerfCounters& perf = PerfCounters::Instance();
+    active = perf.enabled && (!fineGrained || perf.fastReads);
+    if (active) perf.Push(phase);
+}
+
+PerfCounters::Scope::~Scope() {
+    if (active) PerfCounters::Instance().Pop();
+}
+
+PerfCounters& PerfCounters::Instance() {
+    static PerfCounters instance;
+    return instance;
+}
+
+PerfCounters::PerfCounters()
+    : enabled(false), fastReads(false), groupFd(-1), depth(0), lastTime(0.) {
+    for (G4int c = 0; c < kNumCounters; ++c) {
+        fds[c] = -1;
+        pages[c] = nullptr;
+        groupSlot[c] = -1;
+    }
+    lastCounts.fill(0);
+    Reset();
+}
+
+PerfCounters::~PerfCounters() {
+    closeCounters();
+}
+
+void PerfCounters::Enable(G4bool enable) {
+    if (enable == enabled) return;
+    if (!enable) {
+        closeCounters();
+        enabled = false;
+        return;
+    }
+
+    openCounters();
+    Reset();
+    depth = 1;
+    stack[0] = kInit;
+    entries[kInit]++;
+    readCounters(lastCounts);
+    lastTime = now();
+    enabled = true;
+    if (groupFd < 0) {
+        G4cerr << "WARNING: Hardware counters unavailable (" << unavailableReason
+               << "); reporting phase times only" << G4endl;
+    } else {
+        G4cout << "PerfCounters: Hardware counters open (" << (fastReads ? "rdpmc" : "read()") << ")" << G4endl;
+        if (!unavailableReason.empty()) G4cerr << "WARNING: Counter unavailable: " << unavailableReason << G4endl;
+    }
+    if (!fastReads) {
+        G4cout << "PerfCounters: Per-hit SD timing needs rdpmc; ProcessHits stays in the event loop phase" << G4endl;
+    }
+}
+
+void PerfCounters::openCounters() {
+    closeCounters();
+#ifdef __linux__
+    G4int slot = 0;
+    for (G4int c = 0; c < kNumCounters; ++c) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = kCounterConfigs[c];
+        attr.disabled = (groupFd < 0); // The leader starts the whole group
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0));
+        if (fd < 0) {
+            if (unavailableReason.empty()) {
+                unavailableReason = G4String(kCounterNames[c]) + ": " + std::strerror(errno);
+            }
+            continue;
+        }
+        fds[c] = fd;
+        groupSlot[c] = slot++;
+        if (groupFd < 0) groupFd = fd;
+    }
+    if (groupFd < 0) {
+        if (errno == EACCES || errno == EPERM) unavailableReason += ", check /proc/sys/kernel/perf_event_paranoid";
+        return;
+    }
+
+    fastReads = true;
+    long pageSize = sysconf(_SC_PAGESIZE);
+    for (G4int c = 0; c < kNumCounters; ++c) {
+        if (fds[c] < 0) continue;
+        void* page = mmap(nullptr, pageSize, PROT_READ, MAP_SHARED, fds[c], 0);
+        pages[c] = (page == MAP_FAILED) ? nullptr : page;
+        if (!pages[c] || !static_cast<perf_event_mmap_page*>(pages[c])->cap_user_rdpmc) fastReads = false;
+    }
+    ioctl(groupFd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    // A partially opened group still reports the counters that did open
+    if (slot == kNumCounters) unavailableReason.clear();
+#else
+    unavailableReason = "perf_event_open needs Linux";
+#endif
+}
+
+void PerfCounters::closeCounters() {
+#ifdef __linux__
+    long pageSize = sysconf(_SC_PAGESIZE);
+    for (G4int c = 0; c < kNumCounters; ++c) {
+        if (pages[c]) munmap(pages[c], pageSize);
+        if (fds[c] >= 0) close(fds[c]);
+        pages[c] = nullptr;
+        fds[c] = -1;
+        groupSlot[c] = -1;
+    }
+#endif
+    groupFd = -1;
+    fastReads = false;
+    unavailableReason = "";
+}
+
+G4bool PerfCounters::readCounters(std::array<uint64_t, kNumCounters>& values) const {
+#ifdef __linux__
+    if (groupFd < 0) return false;
+    if (fastReads) {
+        G4bool mapped = true;
+        for (G4int c = 0; c < kNumCounters && mapped; ++c) {
+            if (fds[c] >= 0) mapped = readMapped(static_cast<const perf_event_mmap_page*>(pages[c]), values[c]);
+        }
+        if (mapped) return true;
+    }
+    // PERF_FORMAT_GROUP layout: u64 nr, then one u64 value per group member
+    uint64_t buffer[1 + kNumCounters];
+    if (read(groupFd, buffer, sizeof(buffer)) <= 0) return false;
+    for (G4int c = 0; c < kNumCounters; ++c) {
+        if (groupSlot[c] >= 0) values[c] = buffer[1 + groupSlot[c]];
+    }
+    return true;
+#else
+    (void)values;
+    return false;
+#endif
+}
+
+void PerfCounters::charge() {
+    std::array<uint64_t, kNumCounters> counts = lastCounts;
+    G4double time = now();
+    Phase phase = stack[depth - 1];
+    if (readCounters(counts)) {
+        for (G4int c = 0; c < kNumCounters; ++c) {
+            totals[phase][c] += static_cast<G4double>(counts[c] - lastCounts[c]);
+        }
+    }
+    seconds[phase] += time - lastTime;
+    lastCounts = counts;
+    lastTime = time;
+}
+
+void PerfCounters::SetPhase(Phase phase) {
+    if (!enabled || (depth == 1 && stack[0] == phase)) return;
+    charge();
+    depth = 1;
+    stack[0] = phase;
+    entries[phase]++;
+}
+
+void PerfCounters::Push(Phase phase) {
+    if (!enabled || depth >= kMaxDepth) return;
+    charge();
+    stack[depth++] = phase;
+    entries[phase]++;
+}
+
+void PerfCounters::Pop() {
+    if (!enabled || depth <= 1) return;
+    charge();
+    depth--;
+}
+
+void PerfCounters::Reset() {
+    for (auto& phase : totals) phase.fill(0.);
+    seconds.fill(0.);
+    entries.fill(0);
+}
+
+void PerfCounters::Report(G4int runId) {
+    if (!enabled) return;
+    charge();
+
+    G4bool counters = (groupFd >= 0);
+    G4cout << "\n=== Performance Counters ===" << G4endl;
+    G4cout << std::left << std::setw(12) << "phase" << std::right << std::setw(12) << "time [s]";
+    if (counters) {
+        G4cout << std::setw(10) << "IPC" << std::setw(16) << "cache miss/ki" << std::setw(16) << "branch miss/ki";
+    }
+    G4cout << G4endl;
+    for (G4int p = 0; p < kNumPhases; ++p) {
+        if (entries[p] == 0 && seconds[p] == 0.) continue;
+        G4cout << std::left << std::setw(12) << kPhaseNames[p] << std::right << std::setw(12) << seconds[p];
+        if (counters) {
+            G4double instructions = totals[p][kInstructions];
+            auto perKilo = [instructions](G4double count) { return instructions > 0 ? 1000. * count / instructions : 0.; };
+            G4cout << std::setw(10) << (totals[p][kCycles] > 0 ? instructions / totals[p][kCycles] : 0.)
+                   << std::setw(16) << perKilo(totals[p][kCacheMisses])
+                   << std::setw(16) << perKilo(totals[p][kBranchMisses]);
+        }
+        G4cout << G4endl;
+    }
+    if (!unavailableReason.empty()) G4cout << "Counters unavailable: " << unavailableReason << G4endl;
+    G4cout << "============================" << G4endl;
+
+    // Raw totals for benchmark comparisons; counters that could not be opened are left empty
+    std::filesystem::path perfPath = Sim::OutputDirectory("SimPerf") /
+        std::string(Sim::OutputBaseName() + "_perf_" + std::to_string(runId) + ".csv");
+    std::ofstream perfFile(perfPath);
+    if (!perfFile.is_open()) {
+        G4cerr << "ERROR: Failed to open file: " << perfPath << G4endl;
+        return;
+    }
+    perfFile << std::setprecision(12) << "phase,entries,seconds";
+    for (const char* name : kCounterNames) perfFile << "," << name;
+    perfFile << "\n";
+    for (G4int p = 0; p < kNumPhases; ++p) {
+        perfFile << kPhaseNames[p] << "," << entries[p] << "," << seconds[p];
+        for (G4int c = 0; c < kNumCounters; ++c) {
+            perfFile << ",";
+            if (fds[c] >= 0) perfFile << totals[p][c];
+        }
+        perfFile << "\n";
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef PERF_COUNTERS_HH
+#define PERF_COUNTERS_HH
+
+#include "G4Types.hh"
+#include "G4String.hh"
+#include <array>
+#include <cstdint>
+
+// Hardware counters (cycles, instructions, cache misses, branch misses) from perf_event_open,
+// charged to the innermost active run phase so phases never double count. Counters are read
+// in user space with rdpmc where the kernel allows it and with read() otherwise. Without perf
+// support (containers, perf_event_paranoid, non-Linux) only phase wall times are reported.
+class PerfCounters {
+public:
+    enum Phase { kInit, kEventLoop, kSD, kOutput, kNumPhases };
+    enum Counter { kCycles, kInstructions, kCacheMisses, kBranchMisses, kNumCounters };
+
+    // Nested phase for the lifetime of the scope. Per-hit scopes pass fineGrained, and are
+    // skipped unless counters can be read without a system call.
+    class Scope {
+    public:
+        Scope(Phase phase, G4bool fineGrained = false);
+        ~Scope();
+    private:
+        G4bool active;
+    };
+
+    static PerfCounters& Instance();
+
+    void Enable(G4bool enable); // Opens the counters and starts the init phase
+    G4bool IsEnabled() const { return enabled; }
+    void SetPhase(Phase phase); // Switch the outermost phase (init or event loop)
+    void Push(Phase phase);
+    void Pop();
+    void Report(G4int runId); // Print the run summary table and write SimPerf/<base>_perf_<run>.csv
+    void Reset(); // Clear totals for the next run
+
+private:
+    PerfCounters();
+    ~PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    void openCounters();
+    void closeCounters();
+    G4bool readCounters(std::array<uint64_t, kNumCounters>& values) const;
+    void charge(); // Add counts and time since the last transition to the current phase
+
+    static constexpr G4int kMaxDepth = 8;
+
+    G4bool enabled;
+    G4bool fastReads; // rdpmc available for every open counter
+    G4String unavailableReason; // Empty when counters are open
+    int fds[kNumCounters]; // -1 for counters that failed to open
+    void* pages[kNumCounters]; // perf_event_mmap_page for rdpmc
+    int groupFd;
+    G4int groupSlot[kNumCounters]; // Position in the PERF_FORMAT_GROUP read, -1 if not open
+
+    Phase stack[kMaxDepth];
+    G4int depth;
+    std::array<uint64_t, kNumCounters> lastCounts;
+    G4double lastTime; // s
+
+    std::array<std::array<G4double, kNumCounters>, kNumPhases> totals;
+    std::array<G4double, kNumPhases> seconds;
+    std::array<G4long, kNumPhases> entries;
+};
+
+#endif
@@ -0,0 +1,358 @@
+#include "PhotonCodec.hh"
+#include "SimConfig.hh"
+#include "G4ios.hh"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    constexpr G4double kWavelengthStep = 0.01; // nm
+    constexpr int16_t kNoDirection = std::numeric_limits<int16_t>::min(); // Missing generation direction
+    constexpr uint64_t kMaxPendingBlocks = 8; // Pending photons over all tiles, in blocks
+
+    G4double signNotZero(G4double value) { return value < 0 ? -1.0 : 1.0; }
+}
+
+PhotonCodec::PhotonCodec()
+    : current(nullptr), fileOffset(0), blockLimit(65536), pendingPhotons(0), positionGrid(1e-3), timeTick(1e-3),
+      tileSize(0.), weighted(false) {
+    ResetReport();
+}
+
+PhotonCodec::~PhotonCodec() {
+    Close();
+}
+
+// Little-endian file layout:
+//   char[8] "LCPHOT03", float64 position grid (mm), float64 time tick (ns), uint8 weighted,
+//   then blocks of whole events, each a header (see PhotonFormat::BlockStats)
+//     uint32 payload bytes, events, photons, int32 min/max neutron_id, min/max pulse_id,
+//     int64 min/max toa ticks, float32 min/max neutronEnergy, int32 min/max x, min/max y grid steps
+//   followed by one record per neutron with detected photons:
+//     svarint neutron_id delta, svarint pulse_id, svarint pulse_time ticks,
+//     int32 nx, ny, nz, float32 neutronEnergy,
+//     varint nParents, per parent: svarint parent_id delta, type, int32 px, py, pz, float32 parentEnergy
+//     varint nPhotons, per photon: varint id delta, varint parent index, svarint x, y, z deltas,
+//       int16 u, v (octahedral direction), uint16 wavelength, svarint toa delta ticks, [float32 weight]
+//   Positions are int32 grid steps; photon positions are stored relative to their parent, whose
+//   light is emitted within a few mm. IDs are sorted ascending; the first parent and photon
+//   deltas are from 0 and the first toa delta is from the pulse time. A type is a varint index into the types seen so far in the
+//   block; an index equal to the table size is followed by varint length and the new name.
+//   The first neutron_id delta of a block is from -1. svarint is a zigzag-encoded LEB128 varint.
+//   Close() appends the index: per block uint64 offset and a copy of its header, then uint64
+//   nBlocks, uint64 index offset and char[8] "LCPHIDX1". A file without the trailer (interrupted
+//   run) can still be read by walking the block headers.
+//   Tiled files hold per-tile fragments of an event in the blocks of each tile: neutron_id is
+//   ascending within a block but not across blocks, and an event can appear in several blocks.
+G4bool PhotonCodec::Open(const std::filesystem::path& path, G4bool weightColumn) {
+    Close();
+    codecFile.open(path, std::ios::binary);
+    if (!codecFile.is_open()) {
+        G4cerr << "ERROR: Failed to open photon file: " << path << G4endl;
+        return false;
+    }
+
+    positionGrid = Sim::CODEC_POSITION_GRID / mm;
+    timeTick = Sim::CODEC_TIME_TICK / ns;
+    weighted = weightColumn;
+    tileSize = std::max(0., Sim::CODEC_TILE_SIZE / mm);
+    blockLimit = static_cast<uint32_t>(std::max(1, Sim::CODEC_BLOCK_PHOTONS));
+    blockIndex.clear();
+    pending.clear();
+    pendingPhotons = 0;
+
+    std::string header(PhotonFormat::kMagic, PhotonFormat::kMagicSize);
+    header.append(reinterpret_cast<const char*>(&positionGrid), sizeof(positionGrid));
+    header.append(reinterpret_cast<const char*>(&timeTick), sizeof(timeTick));
+    header.push_back(static_cast<char>(weighted));
+    codecFile.write(header.data(), header.size());
+    fileOffset = header.size();
+    bytes += header.size();
+    return true;
+}
+
+void PhotonCodec::Flush() {
+    if (!codecFile.is_open()) return;
+    for (auto& [tile, target] : pending) flushBlock(target);
+    pending.clear();
+}
+
+// Sparse tiles rarely fill a block, so without a bound they would hold their photons until Close
+void PhotonCodec::flushFullestTile() {
+    auto fullest = std::max_element(pending.begin(), pending.end(), [](const auto& a, const auto& b) {
+        return a.second.stats.photons < b.second.stats.photons;
+    });
+    if (fullest == pending.end()) return;
+    flushBlock(fullest->second);
+    pending.erase(fullest);
+}
+
+void PhotonCodec::flushBlock(PendingBlock& target) {
+    if (target.stats.events == 0) return;
+    target.stats.bytes = static_cast<uint32_t>(target.buffer.size());
+    char header[PhotonFormat::kBlockHeaderSize];
+    PhotonFormat::PutStats(target.stats, header);
+    codecFile.write(header, sizeof(header));
+    codecFile.write(target.buffer.data(), target.buffer.size());
+    blockIndex.emplace_back(fileOffset, target.stats);
+    pendingPhotons -= target.stats.photons;
+    fileOffset += sizeof(header) + target.buffer.size();
+    bytes += sizeof(header) + target.buffer.size();
+
+    // The next block decodes without this one
+    target = PendingBlock();
+}
+
+void PhotonCodec::Close() {
+    if (!codecFile.is_open()) return;
+    Flush();
+
+    std::string index;
+    char entry[PhotonFormat::kBlockHeaderSize];
+    for (const auto& [offset, stats] : blockIndex) {
+        index.append(reinterpret_cast<const char*>(&offset), sizeof(offset));
+        PhotonFormat::PutStats(stats, entry);
+        index.append(entry, sizeof(entry));
+    }
+    uint64_t nBlocks = blockIndex.size();
+    index.append(reinterpret_cast<const char*>(&nBlocks), sizeof(nBlocks));
+    index.append(reinterpret_cast<const char*>(&fileOffset), sizeof(fileOffset));
+    index.append(PhotonFormat::kIndexMagic, PhotonFormat::kMagicSize);
+    codecFile.write(index.data(), index.size());
+    bytes += index.size();
+    codecFile.close();
+}
+
+void PhotonCodec::ResetReport() {
+    records = bytes = clampedWavelengths = 0;
+    maxPositionError = maxDirectionError = maxWavelengthError = maxTimeError = 0.;
+}
+
+int32_t PhotonCodec::quantizePosition(G4double position) const {
+    return static_cast<int32_t>(std::llround(position / positionGrid));
+}
+
+int64_t PhotonCodec::quantizeTime(G4double time) const {
+    return std::llround(time / timeTick);
+}
+
+uint16_t PhotonCodec::quantizeWavelength(G4double wavelength) {
+    G4double steps = std::round(wavelength / kWavelengthStep);
+    if (steps < 0 || steps > std::numeric_limits<uint16_t>::max()) {
+        clampedWavelengths++;
+        steps = std::clamp(steps, 0.0, static_cast<G4double>(std::numeric_limits<uint16_t>::max()));
+    }
+    return static_cast<uint16_t>(steps);
+}
+
+void PhotonCodec::putVarint(uint64_t value) {
+    while (value >= 0x80) {
+        current->buffer.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    current->buffer.push_back(static_cast<char>(value));
+}
+
+void PhotonCodec::putType(const G4String& type) {
+    std::vector<G4String>& typeTable = current->typeTable;
+    auto it = std::find(typeTable.begin(), typeTable.end(), type);
+    putVarint(it - typeTable.begin());
+    if (it == typeTable.end()) {
+        typeTable.push_back(type);
+        putVarint(type.size());
+        current->buffer.append(type);
+    }
+}
+
+void PhotonCodec::EncodeDirection(G4double dx, G4double dy, G4double dz, int16_t& u, int16_t& v) {
+    G4double norm = std::abs(dx) + std::abs(dy) + std::abs(dz);
+    if (norm <= 0) {
+        u = v = kNoDirection;
+        return;
+    }
+    G4double a = dx / norm, b = dy / norm;
+    if (dz < 0) {
+        G4double fa = (1 - std::abs(b)) * signNotZero(a);
+        b = (1 - std::abs(a)) * signNotZero(b);
+        a = fa;
+    }
+    u = static_cast<int16_t>(std::lround(std::clamp(a, -1.0, 1.0) * 32767));
+    v = static_cast<int16_t>(std::lround(std::clamp(b, -1.0, 1.0) * 32767));
+}
+
+void PhotonCodec::DecodeDirection(int16_t u, int16_t v, G4double& dx, G4double& dy, G4double& dz) {
+    if (u == kNoDirection && v == kNoDirection) {
+        dx = dy = dz = 0.;
+        return;
+    }
+    G4double a = u / 32767., b = v / 32767.;
+    dz = 1 - std::abs(a) - std::abs(b);
+    if (dz < 0) {
+        G4double fa = (1 - std::abs(b)) * signNotZero(a);
+        b = (1 - std::abs(a)) * signNotZero(b);
+        a = fa;
+    }
+    G4double norm = std::sqrt(a * a + b * b + dz * dz);
+    dx = a / norm;
+    dy = b / norm;
+    dz /= norm;
+}
+
+void PhotonCodec::checkRoundTrip(const PhotonRecord& p, int32_t x, int32_t y, int32_t z,
+                                 int16_t u, int16_t v, uint16_t wavelength, int64_t toa) {
+    maxPositionError = std::max({maxPositionError, std::abs(x * positionGrid - p.x0),
+                                 std::abs(y * positionGrid - p.y0), std::abs(z * positionGrid - p.z0)});
+
+    G4double norm = std::sqrt(p.dx0 * p.dx0 + p.dy0 * p.dy0 + p.dz0 * p.dz0);
+    if (norm > 0) {
+        G4double dx, dy, dz;
+        DecodeDirection(u, v, dx, dy, dz);
+        G4double cosAngle = std::clamp((dx * p.dx0 + dy * p.dy0 + dz * p.dz0) / norm, -1.0, 1.0);
+        maxDirectionError = std::max(maxDirectionError, std::acos(cosAngle));
+    }
+
+    if (p.wavelength >= 0 && p.wavelength <= std::numeric_limits<uint16_t>::max() * kWavelengthStep) {
+        maxWavelengthError = std::max(maxWavelengthError, std::abs(wavelength * kWavelengthStep - p.wavelength));
+    }
+    maxTimeError = std::max(maxTimeError, std::abs(toa * timeTick - p.timeOfArrival));
+}
+
+void PhotonCodec::WriteEvent(const std::vector<PhotonRecord>& photons) {
+    if (!codecFile.is_open() || photons.empty()) return;
+
+    std::vector<const PhotonRecord*> sorted;
+    sorted.reserve(photons.size());
+    for (const auto& p : photons) sorted.push_back(&p);
+    std::sort(sorted.begin(), sorted.end(),
+              [](const PhotonRecord* a, const PhotonRecord* b) { return a->id < b->id; });
+
+    if (tileSize <= 0) {
+        writeFragment(sorted, pending[{0, 0}]);
+        return;
+    }
+
+    // One fragment per tile, each keeping the id order
+    std::map<std::pair<int32_t, int32_t>, std::vector<const PhotonRecord*>> tiles;
+    for (const PhotonRecord* p : sorted) {
+        std::pair<int32_t, int32_t> tile{static_cast<int32_t>(std::floor(p->x0 / tileSize)),
+                                         static_cast<int32_t>(std::floor(p->y0 / tileSize))};
+        tiles[tile].push_back(p);
+    }
+    for (const auto& [tile, fragment] : tiles) writeFragment(fragment, pending[tile]);
+    while (pendingPhotons > kMaxPendingBlocks * blockLimit) flushFullestTile();
+}
+
+void PhotonCodec::writeFragment(const std::vector<const PhotonRecord*>& sorted, PendingBlock& target) {
+    current = &target;
+    PhotonFormat::BlockStats& block = target.stats;
+
+    // Neutron and pulse columns are shared by every photon of the event
+    const PhotonRecord& first = *sorted.front();
+    putSigned(first.neutronId - target.lastNeutronId);
+    target.lastNeutronId = first.neutronId;
+    putSigned(first.pulseId);
+    int64_t pulseTicks = quantizeTime(first.pulseTime);
+    putSigned(pulseTicks);
+    putRaw(quantizePosition(first.nx));
+    putRaw(quantizePosition(first.ny));
+    putRaw(quantizePosition(first.nz));
+    float neutronEnergy = static_cast<float>(first.neutronEnergy);
+    putRaw(neutronEnergy);
+    block.events++;
+    block.photons += static_cast<uint32_t>(sorted.size());
+    pendingPhotons += sorted.size();
+    block.minNeutronId = std::min<int32_t>(block.minNeutronId, first.neutronId);
+    block.maxNeutronId = std::max<int32_t>(block.maxNeutronId, first.neutronId);
+    block.minPulseId = std::min<int32_t>(block.minPulseId, first.pulseId);
+    block.maxPulseId = std::max<int32_t>(block.maxPulseId, first.pulseId);
+    block.minNeutronEnergy = std::min(block.minNeutronEnergy, neutronEnergy);
+    block.maxNeutronEnergy = std::max(block.maxNeutronEnergy, neutronEnergy);
+
+    // Parent table; entries that differ only in their recorded values get their own row
+    std::vector<Parent> parents;
+    std::vector<size_t> parentOf(sorted.size());
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        const PhotonRecord& p = *sorted[i];
+        Parent parent{p.parentId, &p.parentType, quantizePosition(p.px), quantizePosition(p.py),
+                      quantizePosition(p.pz), static_cast<float>(p.parentEnergy)};
+        auto it = std::find_if(parents.begin(), parents.end(), [&parent](const Parent& other) {
+            return other.id == parent.id && *other.type == *parent.type && other.x == parent.x &&
+                   other.y == parent.y && other.z == parent.z && other.energy == parent.energy;
+        });
+        if (it == parents.end()) it = parents.insert(parents.end(), parent);
+        parentOf[i] = it - parents.begin();
+    }
+    std::vector<size_t> order(parents.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(),
+                     [&parents](size_t a, size_t b) { return parents[a].id < parents[b].id; });
+    std::vector<size_t> rank(parents.size());
+    for (size_t i = 0; i < order.size(); ++i) rank[order[i]] = i;
+
+    putVarint(parents.size());
+    G4int lastParentId = 0;
+    for (size_t index : order) {
+        const Parent& parent = parents[index];
+        putSigned(static_cast<int64_t>(parent.id) - lastParentId);
+        lastParentId = parent.id;
+        putType(*parent.type);
+        putRaw(parent.x);
+        putRaw(parent.y);
+        putRaw(parent.z);
+        putRaw(parent.energy);
+    }
+
+    putVarint(sorted.size());
+    G4int lastId = 0;
+    int64_t lastToa = pulseTicks;
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        const PhotonRecord& p = *sorted[i];
+        putVarint(static_cast<uint64_t>(p.id - lastId));
+        lastId = p.id;
+        const Parent& parent = parents[parentOf[i]];
+        putVarint(rank[parentOf[i]]);
+
+        int32_t x = quantizePosition(p.x0), y = quantizePosition(p.y0), z = quantizePosition(p.z0);
+        int16_t u, v;
+        EncodeDirection(p.dx0, p.dy0, p.dz0, u, v);
+        uint16_t wavelength = quantizeWavelength(p.wavelength);
+        int64_t toa = quantizeTime(p.timeOfArrival);
+        putSigned(static_cast<int64_t>(x) - parent.x);
+        putSigned(static_cast<int64_t>(y) - parent.y);
+        putSigned(static_cast<int64_t>(z) - parent.z);
+        putRaw(u);
+        putRaw(v);
+        putRaw(wavelength);
+        putSigned(toa - lastToa);
+        lastToa = toa;
+        block.minToa = std::min(block.minToa, toa);
+        block.maxToa = std::max(block.maxToa, toa);
+        block.minX = std::min(block.minX, x);
+        block.maxX = std::max(block.maxX, x);
+        block.minY = std::min(block.minY, y);
+        block.maxY = std::max(block.maxY, y);
+        if (weighted) putRaw(static_cast<float>(p.weight));
+
+        checkRoundTrip(p, x, y, z, u, v, wavelength, toa);
+        records++;
+    }
+    if (block.photons >= blockLimit) flushBlock(target);
+}
+
+void PhotonCodec::PrintReport() const {
+    if (records == 0) return;
+    G4cout << "\n=== Photon Codec Round-Trip ===" << G4endl;
+    G4cout << "Records: " << records << ", " << static_cast<G4double>(bytes) / records
+           << " bytes/record" << G4endl;
+    G4cout << "Max position error: " << maxPositionError * 1000. << " um (bound "
+           << positionGrid * 500. << " um)" << G4endl;
+    G4cout << "Max direction error: " << maxDirectionError * 1000. << " mrad" << G4endl;
+    G4cout << "Max wavelength error: " << maxWavelengthError << " nm (bound "
+           << kWavelengthStep / 2 << " nm)" << G4endl;
+    G4cout << "Max toa error: " << maxTimeError * 1000. << " ps (bound " << timeTick * 500. << " ps)" << G4endl;
+    if (clampedWavelengths > 0) {
+        G4cerr << "WARNING: " << clampedWavelengths << " wavelengths outside 0-"
+               << std::numeric_limits<uint16_t>::max() * kWavelengthStep << " nm were clamped" << G4endl;
+    }
+    G4cout << "===============================" << G4endl;
+}
@@ -0,0 +1,86 @@
+#ifndef PHOTON_CODEC_HH
+#define PHOTON_CODEC_HH
+
+#include "PhotonRecord.hh"
+#include "PhotonFormat.hh"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Compact binary photon output with explicit quantization bounds. Positions are int32 steps of
+// CODEC_POSITION_GRID, directions are octahedral 2 x int16, wavelengths uint16 in 0.01 nm
+// and times integer CODEC_TIME_TICKs. Per-neutron and per-parent columns are stored once
+// per event; sorted IDs, arrival times and parent-relative positions are delta/varint encoded.
+// Events are grouped into independently decodable blocks with ID/time/energy statistics and
+// a footer index, so PhotonReader can skip blocks and decode the rest in parallel. With
+// CODEC_TILE_SIZE set, each event is split by photon x/y into square tiles that fill separate
+// blocks, so the x/y bounds of a block cover one tile and region queries skip the others.
+// Pending tiles hold at most kMaxPendingBlocks blocks of photons together; past that the
+// fullest tile is written early as a short block.
+class PhotonCodec {
+public:
+    PhotonCodec();
+    ~PhotonCodec();
+
+    G4bool Open(const std::filesystem::path& path, G4bool weighted);
+    G4bool IsOpen() const { return codecFile.is_open(); }
+    void WriteEvent(const std::vector<PhotonRecord>& photons); // Photons of one neutron
+    void Flush(); // Write the pending blocks
+    void Close();
+    void ResetReport();
+    void PrintReport() const; // Round-trip error against the quantization bounds
+
+    // Quantizers shared by the writer and the round-trip check
+    static void EncodeDirection(G4double dx, G4double dy, G4double dz, int16_t& u, int16_t& v);
+    static void DecodeDirection(int16_t u, int16_t v, G4double& dx, G4double& dy, G4double& dz);
+
+private:
+    struct Parent {
+        G4int id;
+        const G4String* type;
+        int32_t x, y, z;
+        float energy;
+    };
+
+    // Block being filled; decoder state restarts with every block
+    struct PendingBlock {
+        std::string buffer; // Payload
+        PhotonFormat::BlockStats stats;
+        std::vector<G4String> typeTable; // Parent type strings, defined inline on first use
+        G4int lastNeutronId;
+        PendingBlock() : lastNeutronId(-1) { stats.Reset(); }
+    };
+
+    int32_t quantizePosition(G4double position) const;
+    int64_t quantizeTime(G4double time) const;
+    uint16_t quantizeWavelength(G4double wavelength);
+    void putVarint(uint64_t value);
+    void putSigned(int64_t value) { putVarint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63)); }
+    template <typename T> void putRaw(T value) { current->buffer.append(reinterpret_cast<const char*>(&value), sizeof(T)); }
+    void putType(const G4String& type);
+    void writeFragment(const std::vector<const PhotonRecord*>& sorted, PendingBlock& target);
+    void flushBlock(PendingBlock& target);
+    void flushFullestTile();
+    void checkRoundTrip(const PhotonRecord& p, int32_t x, int32_t y, int32_t z,
+                        int16_t u, int16_t v, uint16_t wavelength, int64_t toa);
+
+    std::ofstream codecFile;
+    std::map<std::pair<int32_t, int32_t>, PendingBlock> pending; // By x/y tile; one entry when untiled
+    PendingBlock* current; // Block the put* helpers append to
+    std::vector<std::pair<uint64_t, PhotonFormat::BlockStats>> blockIndex; // File offset and header
+    uint64_t fileOffset;
+    uint32_t blockLimit; // Photons per block
+    uint64_t pendingPhotons; // Photons in pending blocks, over all tiles
+    G4double positionGrid, timeTick, tileSize; // mm, ns, mm (0 = untiled)
+    G4bool weighted;
+
+    // Round-trip statistics over the run
+    G4long records, bytes, clampedWavelengths;
+    G4double maxPositionError, maxDirectionError, maxWavelengthError, maxTimeError;
+};
+
+#endif
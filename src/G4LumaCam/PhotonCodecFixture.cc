@@ -0,0 +1,64 @@
+// Writes test_data/photon_codec.lcph, the fixture of test_photon_codec.py, from closed-form
+// photons that the test rebuilds (expected_photons) to check what the decoders return. With a
+// tile size it writes the same photons tiled, test_data/photon_codec_tiled.lcph of
+// test_photon_tiles.py. Build the lumacam-codec-fixture target and run it from the repository root:
+//   lumacam-codec-fixture test_data/photon_codec.lcph
+//   lumacam-codec-fixture test_data/photon_codec_tiled.lcph 5
+#include "PhotonCodec.hh"
+#include "SimConfig.hh"
+#include "G4ios.hh"
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+int main(int argc, char** argv) {
+    if (argc != 2 && argc != 3) {
+        G4cerr << "Usage: " << argv[0] << " <output.lcph> [tile size (mm)]" << G4endl;
+        return 1;
+    }
+
+    Sim::CODEC_BLOCK_PHOTONS = 50; // Several blocks, so block statistics and skipping are exercised
+    if (argc == 3) {
+        Sim::CODEC_TILE_SIZE = std::atof(argv[2]) * mm;
+        // Small blocks, so tiles are written when full, by the pending-photon cap and on Close
+        Sim::CODEC_BLOCK_PHOTONS = 10;
+    }
+    PhotonCodec codec;
+    if (!codec.Open(argv[1], true)) return 1;
+    for (G4int ev = 0; ev < 40; ++ev) {
+        std::vector<PhotonRecord> photons;
+        G4int pulse = ev / 4;
+        for (G4int i = 0; i < 5 + ev % 7; ++i) {
+            PhotonRecord p{};
+            p.id = 1 + 3 * i;
+            p.parentId = 2 + i % 2;
+            p.neutronId = ev;
+            p.pulseId = pulse;
+            p.pulseTime = pulse * 1.0e5;
+            p.nx = 0.5 * std::sin(ev);
+            p.ny = 0.5 * std::cos(ev);
+            p.nz = -0.25;
+            p.neutronEnergy = 1e-6 * (ev + 1);
+            p.px = 10 * std::sin(0.7 * ev);
+            p.py = 10 * std::cos(0.3 * ev);
+            p.pz = 0.1 * ev + 0.01 * (i % 2);
+            p.x0 = p.px + 0.37 * std::sin(1.3 * i + ev);
+            p.y0 = p.py + 0.41 * std::cos(0.9 * i - ev);
+            p.z0 = p.pz + 0.0123456 * i;
+            G4double theta = 0.2 + 0.13 * i + 0.07 * ev, phi = 0.5 * i + 0.3 * ev;
+            p.dx0 = std::sin(theta) * std::cos(phi);
+            p.dy0 = std::sin(theta) * std::sin(phi);
+            p.dz0 = std::cos(theta);
+            p.timeOfArrival = p.pulseTime + 40 + 0.1234567 * i + 0.0017 * ev;
+            p.wavelength = 380 + 0.737 * i + 0.1 * ev;
+            p.parentType = i % 2 ? "proton" : "e-";
+            p.parentEnergy = 0.5 + 0.01 * ev;
+            p.weight = 0.5 + 0.01 * i;
+            photons.push_back(p);
+        }
+        codec.WriteEvent(photons);
+    }
+    codec.Close();
+    codec.PrintReport();
+    return 0;
+}
@@ -0,0 +1,68 @@
+#ifndef PHOTON_FORMAT_HH
+#define PHOTON_FORMAT_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+// On-disk constants of the binary photon format, shared by PhotonCodec (writer) and
+// PhotonReader. Plain C++ so the reader library builds without Geant4.
+namespace PhotonFormat {
+    constexpr char kMagic[] = "LCPHOT03";
+    constexpr char kIndexMagic[] = "LCPHIDX1";
+    constexpr std::size_t kMagicSize = 8;
+    constexpr std::size_t kHeaderSize = kMagicSize + 2 * sizeof(double) + 1; // magic, grid, tick, weighted
+    constexpr std::size_t kTrailerSize = 2 * sizeof(uint64_t) + kMagicSize; // nBlocks, footer offset, magic
+
+    // Block header, repeated in the footer index. Decoder state (neutron_id delta, type table)
+    // restarts at every block, so blocks decode independently.
+    struct BlockStats {
+        uint32_t bytes; // Payload bytes following the header
+        uint32_t events, photons;
+        int32_t minNeutronId, maxNeutronId;
+        int32_t minPulseId, maxPulseId;
+        int64_t minToa, maxToa; // Time ticks
+        float minNeutronEnergy, maxNeutronEnergy; // MeV
+        int32_t minX, maxX, minY, maxY; // Grid steps of the photon x, y columns
+
+        void Reset() {
+            bytes = events = photons = 0;
+            minNeutronId = minPulseId = std::numeric_limits<int32_t>::max();
+            maxNeutronId = maxPulseId = std::numeric_limits<int32_t>::min();
+            minToa = std::numeric_limits<int64_t>::max();
+            maxToa = std::numeric_limits<int64_t>::min();
+            minNeutronEnergy = std::numeric_limits<float>::max();
+            maxNeutronEnergy = std::numeric_limits<float>::lowest();
+            minX = minY = std::numeric_limits<int32_t>::max();
+            maxX = maxY = std::numeric_limits<int32_t>::min();
+        }
+    };
+    constexpr std::size_t kBlockHeaderSize = 3 * 4 + 4 * 4 + 2 * 8 + 2 * 4 + 4 * 4;
+    constexpr std::size_t kIndexEntrySize = sizeof(uint64_t) + kBlockHeaderSize; // Block offset and header
+
+    // Field-by-field little-endian (de)serialization, independent of struct padding
+    inline void PutStats(const BlockStats& s, char* out) {
+        auto put = [&out](const void* value, std::size_t size) { std::memcpy(out, value, size); out += size; };
+        put(&s.bytes, 4); put(&s.events, 4); put(&s.photons, 4);
+        put(&s.minNeutronId, 4); put(&s.maxNeutronId, 4);
+        put(&s.minPulseId, 4); put(&s.maxPulseId, 4);
+        put(&s.minToa, 8); put(&s.maxToa, 8);
+        put(&s.minNeutronEnergy, 4); put(&s.maxNeutronEnergy, 4);
+        put(&s.minX, 4); put(&s.maxX, 4); put(&s.minY, 4); put(&s.maxY, 4);
+    }
+
+    inline BlockStats GetStats(const char* in) {
+        BlockStats s;
+        auto get = [&in](void* value, std::size_t size) { std::memcpy(value, in, size); in += size; };
+        get(&s.bytes, 4); get(&s.events, 4); get(&s.photons, 4);
+        get(&s.minNeutronId, 4); get(&s.maxNeutronId, 4);
+        get(&s.minPulseId, 4); get(&s.maxPulseId, 4);
+        get(&s.minToa, 8); get(&s.maxToa, 8);
+        get(&s.minNeutronEnergy, 4); get(&s.maxNeutronEnergy, 4);
+        get(&s.minX, 4); get(&s.maxX, 4); get(&s.minY, 4); get(&s.maxY, 4);
+        return s;
+    }
+}
+
+#endif
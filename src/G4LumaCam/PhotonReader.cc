@@ -0,0 +1,450 @@
+#include "PhotonReader.hh"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+    const char* kColumnNames[PhotonReader::kNumColumns] = {
+        "id", "parent_id", "neutron_id", "pulse_id", "pulse_time_ns", "x", "y", "z", "dx", "dy", "dz", "toa",
+        "wavelength", "parentName", "px", "py", "pz", "parentEnergy", "nx", "ny", "nz", "neutronEnergy", "weight"};
+    constexpr double kWavelengthStep = 0.01; // nm, as in PhotonCodec
+    constexpr int16_t kNoDirection = std::numeric_limits<int16_t>::min();
+
+    double signNotZero(double value) { return value < 0 ? -1.0 : 1.0; }
+
+    // Same inverse as PhotonCodec::DecodeDirection, which needs Geant4 types
+    void decodeDirection(int16_t u, int16_t v, double& dx, double& dy, double& dz) {
+        if (u == kNoDirection && v == kNoDirection) {
+            dx = dy = dz = 0.;
+            return;
+        }
+        double a = u / 32767., b = v / 32767.;
+        dz = 1 - std::abs(a) - std::abs(b);
+        if (dz < 0) {
+            double fa = (1 - std::abs(b)) * signNotZero(a);
+            b = (1 - std::abs(a)) * signNotZero(b);
+            a = fa;
+        }
+        double norm = std::sqrt(a * a + b * b + dz * dz);
+        dx = a / norm;
+        dy = b / norm;
+        dz /= norm;
+    }
+
+    // Bounds-checked cursor over one block payload
+    class Cursor {
+    public:
+        Cursor(const std::string& data) : pos(data.data()), end(data.data() + data.size()) {}
+        bool AtEnd() const { return pos == end; }
+        uint64_t Varint() {
+            uint64_t value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                need(1);
+                uint8_t byte = static_cast<uint8_t>(*pos++);
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if (byte < 0x80) return value;
+            }
+            throw std::runtime_error("corrupt varint");
+        }
+        int64_t Signed() {
+            uint64_t value = Varint();
+            return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+        }
+        template <typename T> T Raw() {
+            need(sizeof(T));
+            T value;
+            std::memcpy(&value, pos, sizeof(T));
+            pos += sizeof(T);
+            return value;
+        }
+        std::string Bytes(std::size_t size) {
+            need(size);
+            std::string value(pos, size);
+            pos += size;
+            return value;
+        }
+    private:
+        void need(std::size_t size) const {
+            if (static_cast<std::size_t>(end - pos) < size) throw std::runtime_error("truncated block");
+        }
+        const char* pos;
+        const char* end;
+    };
+
+    struct Parent {
+        int32_t id, type;
+        int32_t x, y, z;
+        float energy;
+    };
+
+    template <typename T> bool inRange(T value, const T range[2]) { return value >= range[0] && value <= range[1]; }
+
+    PhotonReader::Query toQuery(const LcphQuery* q) {
+        PhotonReader::Query query;
+        if (!q) return query;
+        std::copy(q->neutronId, q->neutronId + 2, query.neutronId);
+        std::copy(q->pulseId, q->pulseId + 2, query.pulseId);
+        std::copy(q->toa, q->toa + 2, query.toa);
+        std::copy(q->neutronEnergy, q->neutronEnergy + 2, query.neutronEnergy);
+        std::copy(q->x, q->x + 2, query.x);
+        std::copy(q->y, q->y + 2, query.y);
+        return query;
+    }
+
+    void setError(char* error, std::size_t errorSize, const char* message) {
+        if (!error || errorSize == 0) return;
+        std::strncpy(error, message, errorSize - 1);
+        error[errorSize - 1] = '\0';
+    }
+}
+
+PhotonReader::PhotonReader(const std::string& filePath)
+    : path(filePath), fileSize(0), positionGrid(0.), timeTick(0.), weighted(false) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) throw std::runtime_error("cannot open " + path);
+    fileSize = static_cast<uint64_t>(file.tellg());
+
+    char header[PhotonFormat::kHeaderSize];
+    file.seekg(0);
+    if (fileSize < sizeof(header) || !file.read(header, sizeof(header))) {
+        throw std::runtime_error(path + " is not a block-indexed lumacam photon file");
+    }
+    if (std::memcmp(header, PhotonFormat::kMagic, PhotonFormat::kMagicSize) != 0) {
+        throw std::runtime_error(path + " is not a block-indexed lumacam photon file");
+    }
+    std::memcpy(&positionGrid, header + 8, sizeof(double));
+    std::memcpy(&timeTick, header + 16, sizeof(double));
+    weighted = header[24] != 0;
+    loadIndex();
+}
+
+void PhotonReader::loadIndex() {
+    std::ifstream file(path, std::ios::binary);
+    const std::size_t entrySize = PhotonFormat::kIndexEntrySize;
+    if (fileSize >= PhotonFormat::kHeaderSize + PhotonFormat::kTrailerSize) {
+        char trailer[PhotonFormat::kTrailerSize];
+        file.seekg(fileSize - sizeof(trailer));
+        file.read(trailer, sizeof(trailer));
+        uint64_t nBlocks, indexOffset;
+        std::memcpy(&nBlocks, trailer, 8);
+        std::memcpy(&indexOffset, trailer + 8, 8);
+        if (file && std::memcmp(trailer + 16, PhotonFormat::kIndexMagic, PhotonFormat::kMagicSize) == 0 &&
+            indexOffset + nBlocks * entrySize + sizeof(trailer) == fileSize) {
+            std::string index(nBlocks * entrySize, '\0');
+            file.seekg(indexOffset);
+            if (file.read(index.data(), index.size())) {
+                blocks.resize(nBlocks);
+                for (uint64_t b = 0; b < nBlocks; ++b) {
+                    const char* entry = index.data() + b * entrySize;
+                    std::memcpy(&blocks[b].offset, entry, 8);
+                    blocks[b].stats = PhotonFormat::GetStats(entry + 8);
+                }
+                return;
+            }
+            file.clear();
+        }
+    }
+
+    // No index (interrupted run): walk the block headers, dropping a trailing partial block
+    char header[PhotonFormat::kBlockHeaderSize];
+    uint64_t offset = PhotonFormat::kHeaderSize;
+    while (offset + sizeof(header) <= fileSize) {
+        file.seekg(offset);
+        if (!file.read(header, sizeof(header))) break;
+        PhotonFormat::BlockStats stats = PhotonFormat::GetStats(header);
+        if (offset + sizeof(header) + stats.bytes > fileSize) break;
+        blocks.push_back({offset, stats});
+        offset += sizeof(header) + stats.bytes;
+    }
+}
+
+const char* PhotonReader::ColumnName(int column) {
+    return (column >= 0 && column < kNumColumns) ? kColumnNames[column] : "";
+}
+
+bool PhotonReader::IsIntColumn(int column) {
+    return column == kId || column == kParentId || column == kNeutronId || column == kPulseId || column == kParentName;
+}
+
+bool PhotonReader::BlockMayMatch(std::size_t block, const Query& query) const {
+    const PhotonFormat::BlockStats& s = blocks[block].stats;
+    return s.photons > 0 &&
+           s.maxNeutronId >= query.neutronId[0] && s.minNeutronId <= query.neutronId[1] &&
+           s.maxPulseId >= query.pulseId[0] && s.minPulseId <= query.pulseId[1] &&
+           s.maxToa * timeTick >= query.toa[0] && s.minToa * timeTick <= query.toa[1] &&
+           s.maxNeutronEnergy >= query.neutronEnergy[0] && s.minNeutronEnergy <= query.neutronEnergy[1] &&
+           s.maxX * positionGrid >= query.x[0] && s.minX * positionGrid <= query.x[1] &&
+           s.maxY * positionGrid >= query.y[0] && s.minY * positionGrid <= query.y[1];
+}
+
+std::size_t PhotonReader::Plan(const Query& query, std::size_t first, std::size_t maxRows, std::size_t& last) const {
+    std::size_t capacity = 0;
+    last = first;
+    while (last < blocks.size()) {
+        if (BlockMayMatch(last, query)) {
+            std::size_t photons = blocks[last].stats.photons;
+            if (capacity > 0 && capacity + photons > maxRows) break;
+            capacity += photons;
+        }
+        ++last;
+    }
+    return capacity;
+}
+
+std::size_t PhotonReader::decodeBlock(std::size_t block, const Query& query, const std::vector<int>& columns,
+                                      void* const* outputs, std::size_t offset, std::string& payload,
+                                      std::vector<std::string>& localTypes) const {
+    const BlockEntry& entry = blocks[block];
+    payload.resize(entry.stats.bytes);
+    std::ifstream file(path, std::ios::binary);
+    file.seekg(entry.offset + PhotonFormat::kBlockHeaderSize);
+    if (!file.read(payload.data(), payload.size())) throw std::runtime_error("cannot read block from " + path);
+
+    bool needDirection = false;
+    for (int column : columns) needDirection |= (column == kDx || column == kDy || column == kDz);
+
+    Cursor in(payload);
+    localTypes.clear();
+    std::vector<Parent> parents;
+    // The output slice holds entry.stats.photons rows; a payload that disagrees with the header must not overrun it
+    std::size_t rows = 0, decoded = 0;
+    int64_t neutronId = -1;
+    double values[kNumColumns] = {};
+    while (!in.AtEnd()) {
+        neutronId += in.Signed();
+        int64_t pulseId = in.Signed();
+        int64_t pulseTicks = in.Signed();
+        int32_t nx = in.Raw<int32_t>(), ny = in.Raw<int32_t>(), nz = in.Raw<int32_t>();
+        float neutronEnergy = in.Raw<float>();
+
+        parents.resize(in.Varint());
+        int64_t parentId = 0;
+        for (Parent& parent : parents) {
+            parentId += in.Signed();
+            parent.id = static_cast<int32_t>(parentId);
+            uint64_t type = in.Varint();
+            if (type == localTypes.size()) localTypes.push_back(in.Bytes(in.Varint()));
+            if (type >= localTypes.size()) throw std::runtime_error("corrupt parent type");
+            parent.type = static_cast<int32_t>(type);
+            parent.x = in.Raw<int32_t>();
+            parent.y = in.Raw<int32_t>();
+            parent.z = in.Raw<int32_t>();
+            parent.energy = in.Raw<float>();
+        }
+
+        // Event columns and the row predicates that depend only on them
+        bool eventMatches = inRange(neutronId, query.neutronId) && inRange(pulseId, query.pulseId) &&
+                            inRange(static_cast<double>(neutronEnergy), query.neutronEnergy);
+        values[kNeutronId] = static_cast<double>(neutronId);
+        values[kPulseId] = static_cast<double>(pulseId);
+        values[kPulseTime] = pulseTicks * timeTick;
+        values[kNx] = nx * positionGrid;
+        values[kNy] = ny * positionGrid;
+        values[kNz] = nz * positionGrid;
+        values[kNeutronEnergy] = neutronEnergy;
+
+        uint64_t nPhotons = in.Varint();
+        if (nPhotons > entry.stats.photons - decoded) throw std::runtime_error("block holds more photons than its header");
+        decoded += nPhotons;
+        int64_t id = 0, toa = pulseTicks;
+        for (uint64_t i = 0; i < nPhotons; ++i) {
+            id += static_cast<int64_t>(in.Varint());
+            uint64_t parentIndex = in.Varint();
+            if (parentIndex >= parents.size()) throw std::runtime_error("corrupt parent index");
+            const Parent& parent = parents[parentIndex];
+            int64_t x = parent.x + in.Signed(), y = parent.y + in.Signed(), z = parent.z + in.Signed();
+            int16_t u = in.Raw<int16_t>(), v = in.Raw<int16_t>();
+            uint16_t wavelength = in.Raw<uint16_t>();
+            toa += in.Signed();
+            float weight = weighted ? in.Raw<float>() : 1.0f;
+
+            double toaNs = toa * timeTick;
+            if (!eventMatches || !inRange(toaNs, query.toa) || !inRange(x * positionGrid, query.x) ||
+                !inRange(y * positionGrid, query.y)) {
+                continue;
+            }
+
+            values[kId] = static_cast<double>(id);
+            values[kParentId] = parent.id;
+            values[kX] = x * positionGrid;
+            values[kY] = y * positionGrid;
+            values[kZ] = z * positionGrid;
+            if (needDirection) decodeDirection(u, v, values[kDx], values[kDy], values[kDz]);
+            values[kToa] = toaNs;
+            values[kWavelength] = wavelength * kWavelengthStep;
+            values[kParentName] = parent.type; // Block-local until Read() maps it
+            values[kPx] = parent.x * positionGrid;
+            values[kPy] = parent.y * positionGrid;
+            values[kPz] = parent.z * positionGrid;
+            values[kParentEnergy] = parent.energy;
+            values[kWeight] = weight;
+
+            std::size_t row = offset + rows++;
+            for (std::size_t c = 0; c < columns.size(); ++c) {
+                if (IsIntColumn(columns[c])) {
+                    static_cast<int32_t*>(outputs[c])[row] = static_cast<int32_t>(values[columns[c]]);
+                } else {
+                    static_cast<double*>(outputs[c])[row] = values[columns[c]];
+                }
+            }
+        }
+    }
+    if (decoded != entry.stats.photons) throw std::runtime_error("block holds fewer photons than its header");
+    return rows;
+}
+
+int32_t PhotonReader::typeCode(const std::string& name) {
+    auto it = std::find(types.begin(), types.end(), name);
+    if (it != types.end()) return static_cast<int32_t>(it - types.begin());
+    types.push_back(name);
+    return static_cast<int32_t>(types.size() - 1);
+}
+
+std::size_t PhotonReader::Read(const Query& query, std::size_t first, std::size_t last, const std::vector<int>& columns,
+                               void* const* outputs, std::size_t capacity, unsigned threads) {
+    for (int column : columns) {
+        if (column < 0 || column >= kNumColumns) throw std::runtime_error("unknown column");
+    }
+    last = std::min(last, blocks.size());
+
+    // Each selected block decodes into its own slice of the outputs; slices are compacted afterwards
+    std::vector<std::size_t> selected, offsets;
+    std::size_t total = 0;
+    for (std::size_t b = first; b < last; ++b) {
+        if (!BlockMayMatch(b, query)) continue;
+        selected.push_back(b);
+        offsets.push_back(total);
+        total += blocks[b].stats.photons;
+    }
+    if (total > capacity) throw std::runtime_error("output capacity too small");
+
+    std::vector<std::size_t> rows(selected.size(), 0);
+    std::vector<std::vector<std::string>> localTypes(selected.size());
+    std::atomic<std::size_t> next(0);
+    std::string failure;
+    std::mutex failureMutex;
+    auto worker = [&]() {
+        std::string payload;
+        for (std::size_t i = next++; i < selected.size(); i = next++) {
+            try {
+                rows[i] = decodeBlock(selected[i], query, columns, outputs, offsets[i], payload, localTypes[i]);
+            } catch (const std::exception& e) {
+                std::lock_guard<std::mutex> lock(failureMutex);
+                if (failure.empty()) failure = "block " + std::to_string(selected[i]) + ": " + e.what();
+            }
+        }
+    };
+    unsigned nThreads = threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+    nThreads = static_cast<unsigned>(std::min<std::size_t>(nThreads, selected.size()));
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < nThreads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& thread : pool) thread.join();
+    if (!failure.empty()) throw std::runtime_error(failure);
+
+    // Map block-local parent types to reader-wide codes, then close the gaps between slices
+    auto nameColumn = std::find(columns.begin(), columns.end(), static_cast<int>(kParentName));
+    std::lock_guard<std::mutex> lock(typesMutex);
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < selected.size(); ++i) {
+        if (nameColumn != columns.end()) {
+            std::vector<int32_t> codes;
+            for (const std::string& name : localTypes[i]) codes.push_back(typeCode(name));
+            int32_t* names = static_cast<int32_t*>(outputs[nameColumn - columns.begin()]) + offsets[i];
+            for (std::size_t r = 0; r < rows[i]; ++r) names[r] = codes[names[r]];
+        }
+        if (offsets[i] != count) {
+            for (std::size_t c = 0; c < columns.size(); ++c) {
+                std::size_t width = IsIntColumn(columns[c]) ? sizeof(int32_t) : sizeof(double);
+                char* data = static_cast<char*>(outputs[c]);
+                std::memmove(data + count * width, data + offsets[i] * width, rows[i] * width);
+            }
+        }
+        count += rows[i];
+    }
+    return count;
+}
+
+extern "C" {
+    void* lcph_open(const char* path, char* error, std::size_t errorSize) {
+        try {
+            return new PhotonReader(path);
+        } catch (const std::exception& e) {
+            setError(error, errorSize, e.what());
+            return nullptr;
+        }
+    }
+
+    void lcph_close(void* reader) {
+        delete static_cast<PhotonReader*>(reader);
+    }
+
+    int lcph_weighted(void* reader) {
+        return static_cast<PhotonReader*>(reader)->Weighted();
+    }
+
+    std::size_t lcph_num_blocks(void* reader) {
+        return static_cast<PhotonReader*>(reader)->NumBlocks();
+    }
+
+    void lcph_block_ids(void* reader, std::size_t block, int64_t* values) {
+        const PhotonFormat::BlockStats& s = static_cast<PhotonReader*>(reader)->Block(block);
+        int64_t ids[6] = {s.events, s.photons, s.minNeutronId, s.maxNeutronId, s.minPulseId, s.maxPulseId};
+        std::copy(ids, ids + 6, values);
+    }
+
+    void lcph_block_ranges(void* reader, std::size_t block, double* values) {
+        PhotonReader* r = static_cast<PhotonReader*>(reader);
+        const PhotonFormat::BlockStats& s = r->Block(block);
+        values[0] = s.minToa * r->TimeTick();
+        values[1] = s.maxToa * r->TimeTick();
+        values[2] = s.minNeutronEnergy;
+        values[3] = s.maxNeutronEnergy;
+        values[4] = s.minX * r->PositionGrid();
+        values[5] = s.maxX * r->PositionGrid();
+        values[6] = s.minY * r->PositionGrid();
+        values[7] = s.maxY * r->PositionGrid();
+    }
+
+    int lcph_num_columns() {
+        return PhotonReader::kNumColumns;
+    }
+
+    const char* lcph_column_name(int column) {
+        return PhotonReader::ColumnName(column);
+    }
+
+    int lcph_column_is_int(int column) {
+        return PhotonReader::IsIntColumn(column);
+    }
+
+    std::size_t lcph_plan(void* reader, const LcphQuery* query, std::size_t first, std::size_t maxRows,
+                          std::size_t* last) {
+        return static_cast<PhotonReader*>(reader)->Plan(toQuery(query), first, maxRows, *last);
+    }
+
+    int64_t lcph_read(void* reader, const LcphQuery* query, std::size_t first, std::size_t last,
+                      const int* columns, std::size_t nColumns, void** outputs, std::size_t capacity,
+                      int threads, char* error, std::size_t errorSize) {
+        try {
+            std::vector<int> columnList(columns, columns + nColumns);
+            return static_cast<int64_t>(static_cast<PhotonReader*>(reader)->Read(
+                toQuery(query), first, last, columnList, outputs, capacity, static_cast<unsigned>(std::max(threads, 0))));
+        } catch (const std::exception& e) {
+            setError(error, errorSize, e.what());
+            return -1;
+        }
+    }
+
+    std::size_t lcph_num_types(void* reader) {
+        return static_cast<PhotonReader*>(reader)->Types().size();
+    }
+
+    const char* lcph_type_name(void* reader, std::size_t index) {
+        return static_cast<PhotonReader*>(reader)->Types()[index].c_str();
+    }
+}
@@ -0,0 +1,108 @@
+#ifndef PHOTON_READER_HH
+#define PHOTON_READER_HH
+
+#include "PhotonFormat.hh"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Reader for binary photon files (.lcph, written by PhotonCodec). Blocks whose statistics
+// cannot match the query are skipped without being read, the rest are decoded in parallel
+// straight into caller-owned column arrays, and only the requested columns are stored.
+// Built without Geant4 as liblumacam_reader, which lumacam.reader loads through the C API below.
+class PhotonReader {
+public:
+    // Integer columns are int32 (parentName holds an index into Types()), the rest float64
+    enum Column {
+        kId, kParentId, kNeutronId, kPulseId, kPulseTime, kX, kY, kZ, kDx, kDy, kDz, kToa,
+        kWavelength, kParentName, kPx, kPy, kPz, kParentEnergy, kNx, kNy, kNz, kNeutronEnergy,
+        kWeight, kNumColumns
+    };
+
+    // Inclusive ranges; toa in ns, neutronEnergy in MeV, photon x and y in mm
+    struct Query {
+        int64_t neutronId[2] = {std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max()};
+        int64_t pulseId[2] = {std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max()};
+        double toa[2] = {-std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()};
+        double neutronEnergy[2] = {-std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()};
+        double x[2] = {-std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()};
+        double y[2] = {-std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()};
+    };
+
+    explicit PhotonReader(const std::string& path); // Throws std::runtime_error
+
+    static const char* ColumnName(int column);
+    static bool IsIntColumn(int column);
+
+    bool Weighted() const { return weighted; }
+    double TimeTick() const { return timeTick; } // ns
+    double PositionGrid() const { return positionGrid; } // mm
+    std::size_t NumBlocks() const { return blocks.size(); }
+    const PhotonFormat::BlockStats& Block(std::size_t block) const { return blocks[block].stats; }
+    bool BlockMayMatch(std::size_t block, const Query& query) const;
+
+    // Blocks from first that may match, up to about maxRows photons (at least one block).
+    // Sets last to one past the final block and returns the photon capacity they need.
+    std::size_t Plan(const Query& query, std::size_t first, std::size_t maxRows, std::size_t& last) const;
+
+    // Decode blocks [first, last) and return the matching row count. outputs[i] receives
+    // column columns[i] and holds at least Plan()'s capacity rows.
+    std::size_t Read(const Query& query, std::size_t first, std::size_t last, const std::vector<int>& columns,
+                     void* const* outputs, std::size_t capacity, unsigned threads);
+
+    const std::vector<std::string>& Types() const { return types; } // Parent names seen so far
+
+private:
+    struct BlockEntry {
+        uint64_t offset; // File offset of the block header
+        PhotonFormat::BlockStats stats;
+    };
+
+    void loadIndex();
+    std::size_t decodeBlock(std::size_t block, const Query& query, const std::vector<int>& columns,
+                            void* const* outputs, std::size_t offset, std::string& payload,
+                            std::vector<std::string>& localTypes) const;
+    int32_t typeCode(const std::string& name);
+
+    std::string path;
+    uint64_t fileSize;
+    double positionGrid, timeTick; // mm, ns
+    bool weighted;
+    std::vector<BlockEntry> blocks;
+    std::vector<std::string> types;
+    std::mutex typesMutex;
+};
+
+// C API for ctypes. Functions returning a status set error (up to errorSize bytes) on failure.
+extern "C" {
+    struct LcphQuery {
+        int64_t neutronId[2], pulseId[2];
+        double toa[2], neutronEnergy[2];
+        double x[2], y[2];
+    };
+
+    void* lcph_open(const char* path, char* error, std::size_t errorSize);
+    void lcph_close(void* reader);
+    int lcph_weighted(void* reader);
+    std::size_t lcph_num_blocks(void* reader);
+    // events, photons, min/max neutron_id, min/max pulse_id
+    void lcph_block_ids(void* reader, std::size_t block, int64_t* values);
+    // min/max toa (ns), min/max neutronEnergy (MeV), min/max x, min/max y (mm)
+    void lcph_block_ranges(void* reader, std::size_t block, double* values);
+    int lcph_num_columns();
+    const char* lcph_column_name(int column);
+    int lcph_column_is_int(int column);
+    std::size_t lcph_plan(void* reader, const LcphQuery* query, std::size_t first, std::size_t maxRows,
+                          std::size_t* last);
+    // Returns the row count, or -1 on error
+    int64_t lcph_read(void* reader, const LcphQuery* query, std::size_t first, std::size_t last,
+                      const int* columns, std::size_t nColumns, void** outputs, std::size_t capacity,
+                      int threads, char* error, std::size_t errorSize);
+    std::size_t lcph_num_types(void* reader);
+    const char* lcph_type_name(void* reader, std::size_t index);
+}
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef PHOTON_RECORD_HH
+#define PHOTON_RECORD_HH
+
+#include "G4Types.hh"
+#include "G4String.hh"
+
+// One detected optical photon together with its parent and neutron history
+struct PhotonRecord {
+    G4int id, parentId, neutronId;
+    G4double x, y, z, dx, dy, dz;  // Position and direction at monitor
+    G4double x0, y0, z0, dx0, dy0, dz0;  // Position and direction at generation
+    G4double timeOfArrival;
+    G4double wavelength, parentEnergy, neutronEnergy;
+    G4String parentType;
+    G4double px, py, pz, nx, ny, nz;
+    G4int pulseId;
+    G4double pulseTime;
+    G4double weight;  // Statistical weight of the photon track
+};
+
+#endif
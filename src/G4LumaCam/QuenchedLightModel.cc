@@ -0,0 +1,185 @@
+#include "QuenchedLightModel.hh"
+#include "SimConfig.hh"
+#include "LogGrid.hh"
+#include "MaterialBuilder.hh"
+#include "G4Alpha.hh"
+#include "G4EmCalculator.hh"
+#include "G4FastStep.hh"
+#include "G4FastTrack.hh"
+#include "G4OpticalPhoton.hh"
+#include "G4Poisson.hh"
+#include "G4Proton.hh"
+#include "G4RandomDirection.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Triton.hh"
+#include "Randomize.hh"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace {
+    G4ThreeVector randomPolarization(const G4ThreeVector& direction) {
+        G4ThreeVector perpendicular = direction.orthogonal().unit();
+        G4double phi = twopi * G4UniformRand();
+        return std::cos(phi) * perpendicular + std::sin(phi) * direction.cross(perpendicular);
+    }
+}
+
+QuenchedLightModel::QuenchedLightModel(const G4String& name, G4Region* envelope)
+    : G4VFastSimulationModel(name, envelope) {}
+
+G4bool QuenchedLightModel::IsApplicable(const G4ParticleDefinition& particle) {
+    return &particle == G4Proton::Definition() || &particle == G4Triton::Definition() ||
+           &particle == G4Alpha::Definition();
+}
+
+G4double QuenchedLightModel::LightTable::Interpolate(const std::vector<G4double>& values, G4double kineticEnergy) const {
+    if (kineticEnergy < energy.front()) return values.front() * kineticEnergy / energy.front();
+    return LogGrid::Interpolate(values, LogGrid::Position(kineticEnergy, energy.front(), energy.back(), energy.size()));
+}
+
+G4double QuenchedLightModel::LightTable::RangeAtLight(G4double visible) const {
+    if (visible < light.front()) return range.front() * visible / light.front();
+    std::size_t i = std::upper_bound(light.begin(), light.end(), visible) - light.begin();
+    if (i >= light.size()) return range.back();
+    G4double f = (visible - light[i - 1]) / (light[i] - light[i - 1]);
+    return range[i - 1] + f * (range[i] - range[i - 1]);
+}
+
+G4double QuenchedLightModel::LightTable::EnergyAtRange(G4double residualRange) const {
+    if (residualRange < range.front()) return energy.front() * residualRange / range.front();
+    std::size_t i = std::upper_bound(range.begin(), range.end(), residualRange) - range.begin();
+    if (i >= range.size()) return energy.back();
+    G4double f = (residualRange - range[i - 1]) / (range[i] - range[i - 1]);
+    return energy[i - 1] + f * (energy[i] - energy[i - 1]);
+}
+
+G4double QuenchedLightModel::LightTable::SamplePhotonEnergy() const {
+    G4double target = G4UniformRand() * spectrumCdf.back();
+    std::size_t i = std::upper_bound(spectrumCdf.begin(), spectrumCdf.end(), target) - spectrumCdf.begin();
+    i = std::clamp<std::size_t>(i, 1, spectrumCdf.size() - 1);
+    G4double width = spectrumCdf[i] - spectrumCdf[i - 1];
+    G4double f = width > 0 ? (target - spectrumCdf[i - 1]) / width : 0.;
+    return photonEnergy[i - 1] + f * (photonEnergy[i] - photonEnergy[i - 1]);
+}
+
+// Exponential decay convolved with an exponential rise, as in G4Scintillation
+G4double QuenchedLightModel::LightTable::SampleEmissionTime() const {
+    G4double tau = (G4UniformRand() < fastFraction) ? fastTau : slowTau;
+    G4double time = -tau * std::log(1. - G4UniformRand());
+    if (riseTau > 0) time -= riseTau * std::log(1. - G4UniformRand());
+    return time;
+}
+
+const QuenchedLightModel::LightTable* QuenchedLightModel::tableFor(const G4Material* material,
+                                                                   const G4ParticleDefinition* particle) {
+    auto key = std::make_pair(material, particle);
+    auto it = tables.find(key);
+    if (it != tables.end()) return it->second.energy.empty() ? nullptr : &it->second;
+
+    LightTable& table = tables[key];
+    MaterialBuilder::ScintType type;
+    G4MaterialPropertiesTable* properties = material->GetMaterialPropertiesTable();
+    if (!MaterialBuilder::scintTypeOf(material, type) || type == MaterialBuilder::ScintType::LYSO || !properties ||
+        !properties->ConstPropertyExists("SCINTILLATIONYIELD") || !properties->GetProperty("FASTCOMPONENT")) {
+        return nullptr;
+    }
+    auto constant = [properties](const char* name, G4double fallback) {
+        return properties->ConstPropertyExists(name) ? properties->GetConstProperty(name) : fallback;
+    };
+    table.yield = properties->GetConstProperty("SCINTILLATIONYIELD");
+    table.resolution = constant("RESOLUTIONSCALE", 1.);
+    table.fastFraction = constant("YIELDRATIO", 1.);
+    table.fastTau = constant("FASTTIMECONSTANT", 0.);
+    table.slowTau = constant("SLOWTIMECONSTANT", table.fastTau);
+    table.riseTau = constant("SCINTILLATIONRISETIME", 0.);
+
+    G4MaterialPropertyVector* spectrum = properties->GetProperty("FASTCOMPONENT");
+    G4double cumulative = 0.;
+    for (std::size_t i = 0; i < spectrum->GetVectorLength(); ++i) {
+        if (i > 0) {
+            cumulative += 0.5 * ((*spectrum)[i] + (*spectrum)[i - 1]) * (spectrum->Energy(i) - spectrum->Energy(i - 1));
+        }
+        table.photonEnergy.push_back(spectrum->Energy(i));
+        table.spectrumCdf.push_back(cumulative);
+    }
+
+    // Range and visible energy integrated over the stopping power, with the material's Birks constant
+    G4EmCalculator calculator;
+    G4double birks = material->GetIonisation()->GetBirksConstant();
+    table.energy = LogGrid::Make(1. * keV, 30. * MeV);
+    G4double range = 0., light = 0., lastEnergy = 0., lastInverse = 0., lastQuenched = 0.;
+    for (G4double energy : table.energy) {
+        G4double dedx = std::max(calculator.ComputeTotalDEDX(energy, particle, material), DBL_MIN);
+        G4double inverse = 1. / dedx, quenched = 1. / (1. + birks * dedx);
+        if (lastEnergy == 0.) {
+            range = energy * inverse; // Constant stopping power below the grid
+            light = energy * quenched;
+        } else {
+            range += 0.5 * (inverse + lastInverse) * (energy - lastEnergy);
+            light += 0.5 * (quenched + lastQuenched) * (energy - lastEnergy);
+        }
+        table.range.push_back(range);
+        table.light.push_back(light);
+        lastEnergy = energy;
+        lastInverse = inverse;
+        lastQuenched = quenched;
+    }
+    G4cout << "QuenchedLightModel: " << particle->GetParticleName() << " light table for " << material->GetName()
+           << " (kB " << birks / (mm / MeV) << " mm/MeV)" << G4endl;
+    return &table;
+}
+
+G4bool QuenchedLightModel::ModelTrigger(const G4FastTrack& fastTrack) {
+    if (!Sim::fastScintModels && !Sim::rangeTableLight) return false;
+    const G4Track* track = fastTrack.GetPrimaryTrack();
+    const LightTable* table = tableFor(track->GetMaterial(), track->GetDefinition());
+    return table && track->GetKineticEnergy() <= table->energy.back();
+}
+
+void QuenchedLightModel::DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep) {
+    const G4Track* track = fastTrack.GetPrimaryTrack();
+    const LightTable* table = tableFor(track->GetMaterial(), track->GetDefinition());
+    G4double energy = track->GetKineticEnergy();
+    G4ThreeVector start = track->GetPosition(), direction = track->GetMomentumDirection();
+    G4double totalRange = table->Interpolate(table->range, energy);
+    G4double totalLight = table->Interpolate(table->light, energy);
+    G4double exitDistance = fastTrack.GetEnvelopeSolid()->DistanceToOut(
+        fastTrack.GetPrimaryTrackLocalPosition(), fastTrack.GetPrimaryTrackLocalDirection());
+
+    // Photon count fluctuations as in G4Scintillation
+    G4double mean = table->yield * totalLight;
+    G4int photons = (mean > 10.)
+        ? std::max(0, static_cast<G4int>(std::lround(G4RandGauss::shoot(mean, table->resolution * std::sqrt(mean)))))
+        : static_cast<G4int>(G4Poisson(mean));
+
+    // Each photon is emitted where the light still to come equals a uniform fraction of the total;
+    // light from beyond the envelope exit is lost with the escaping particle
+    std::vector<G4double> distances;
+    distances.reserve(photons);
+    for (G4int i = 0; i < photons; ++i) {
+        G4double distance = totalRange - table->RangeAtLight(G4UniformRand() * totalLight);
+        if (distance < exitDistance) distances.push_back(distance);
+    }
+
+    G4double speed = track->GetVelocity();
+    G4double weight = track->GetWeight();
+    fastStep.SetNumberOfSecondaryTracks(static_cast<G4int>(distances.size()));
+    for (G4double distance : distances) {
+        G4ThreeVector photonDirection = G4RandomDirection();
+        G4DynamicParticle photon(G4OpticalPhoton::Definition(), photonDirection, table->SamplePhotonEnergy());
+        G4ThreeVector polarization = randomPolarization(photonDirection);
+        photon.SetPolarization(polarization.x(), polarization.y(), polarization.z());
+        G4double time = track->GetGlobalTime() + distance / speed + table->SampleEmissionTime();
+        G4Track* secondary = fastStep.CreateSecondaryTrack(photon, start + distance * direction, time, false);
+        secondary->SetWeight(weight);
+    }
+
+    G4double stopDistance = std::min(totalRange, exitDistance);
+    G4double residual = (totalRange > exitDistance) ? table->EnergyAtRange(totalRange - exitDistance) : 0.;
+    fastStep.KillPrimaryTrack();
+    fastStep.ProposePrimaryTrackFinalPosition(start + stopDistance * direction, false);
+    fastStep.ProposePrimaryTrackFinalTime(track->GetGlobalTime() + stopDistance / speed);
+    fastStep.ProposePrimaryTrackPathLength(stopDistance);
+    fastStep.ProposeTotalEnergyDeposited(energy - residual);
+}
@@ -0,0 +1,41 @@
+#ifndef QUENCHED_LIGHT_MODEL_HH
+#define QUENCHED_LIGHT_MODEL_HH
+
+#include "G4VFastSimulationModel.hh"
+#include <map>
+#include <utility>
+#include <vector>
+
+// Charged reaction products (p, t, alpha) in the scintillator. Instead of tracking them, the
+// Birks-quenched scintillation light of the whole track is emitted along a straight range,
+// placed with precomputed range and visible-energy integrals of the stopping power. Used for the
+// products of ScintReactionModel, or on its own with /lumacam/rangeTableLight to shortcut the
+// recoils and capture products of full HP transport.
+class QuenchedLightModel : public G4VFastSimulationModel {
+public:
+    QuenchedLightModel(const G4String& name, G4Region* envelope);
+
+    G4bool IsApplicable(const G4ParticleDefinition& particle) override;
+    G4bool ModelTrigger(const G4FastTrack& fastTrack) override;
+    void DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep) override;
+
+private:
+    struct LightTable {
+        std::vector<G4double> energy, range, light; // Grid, CSDA range (mm) and visible energy (MeV)
+        G4double yield, resolution; // Photons per MeV visible, RESOLUTIONSCALE
+        G4double fastFraction, fastTau, slowTau, riseTau; // Emission time constants (ns)
+        std::vector<G4double> photonEnergy, spectrumCdf; // FASTCOMPONENT emission spectrum
+
+        G4double Interpolate(const std::vector<G4double>& values, G4double kineticEnergy) const;
+        G4double RangeAtLight(G4double visible) const; // Residual range with this much light left
+        G4double EnergyAtRange(G4double residualRange) const;
+        G4double SamplePhotonEnergy() const;
+        G4double SampleEmissionTime() const;
+    };
+
+    const LightTable* tableFor(const G4Material* material, const G4ParticleDefinition* particle);
+
+    std::map<std::pair<const G4Material*, const G4ParticleDefinition*>, LightTable> tables;
+};
+
+#endif
@@ -0,0 +1,142 @@
+#include "ScintReactionModel.hh"
+#include "SimConfig.hh"
+#include "LogGrid.hh"
+#include "G4Alpha.hh"
+#include "G4FastStep.hh"
+#include "G4FastTrack.hh"
+#include "G4HadronicProcessStore.hh"
+#include "G4IonTable.hh"
+#include "G4Neutron.hh"
+#include "G4Proton.hh"
+#include "G4RandomDirection.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Triton.hh"
+#include "G4UnitsTable.hh"
+#include "Randomize.hh"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace {
+    void createProduct(G4FastStep& fastStep, const G4ParticleDefinition* particle, G4double mass,
+                       const G4ThreeVector& velocity, const G4ThreeVector& position, G4double time, G4double weight) {
+        G4DynamicParticle product(particle, velocity.unit(), 0.5 * mass * velocity.mag2());
+        G4Track* secondary = fastStep.CreateSecondaryTrack(product, position, time, false);
+        secondary->SetWeight(weight);
+    }
+}
+
+ScintReactionModel::ScintReactionModel(const G4String& name, G4Region* envelope)
+    : G4VFastSimulationModel(name, envelope) {}
+
+G4bool ScintReactionModel::IsApplicable(const G4ParticleDefinition& particle) {
+    return &particle == G4Neutron::Definition();
+}
+
+G4double ScintReactionModel::Channel::Sigma(G4double energy) const {
+    return std::exp(LogGrid::Interpolate(logSigma, LogGrid::Position(energy, emin, emax, logSigma.size())));
+}
+
+const ScintReactionModel::Channel* ScintReactionModel::channelFor(const G4Material* material) {
+    auto it = channels.find(material);
+    if (it != channels.end()) return it->second.logSigma.empty() ? nullptr : &it->second;
+
+    Channel& channel = channels[material];
+    if (!MaterialBuilder::scintTypeOf(material, channel.type) || channel.type == MaterialBuilder::ScintType::LYSO) {
+        return nullptr;
+    }
+
+    // Target element and the energies where its channel carries the light output: recoil light
+    // below 1 keV is negligible in EJ200, and 6Li capture dominates GS20 only at low energy
+    G4bool protonRecoil = (channel.type == MaterialBuilder::ScintType::EJ200);
+    G4int targetZ = protonRecoil ? 1 : 3;
+    channel.emin = protonRecoil ? 1. * keV : 1e-5 * eV;
+    channel.emax = protonRecoil ? 20. * MeV : 10. * keV;
+
+    G4HadronicProcessStore* store = G4HadronicProcessStore::Instance();
+    const G4ElementVector* elements = material->GetElementVector();
+    const G4double* atomDensities = material->GetVecNbOfAtomsPerVolume();
+    G4bool hasTarget = false;
+    for (G4double energy : LogGrid::Make(channel.emin, channel.emax)) {
+        G4double sigma = 0.;
+        for (std::size_t i = 0; i < material->GetNumberOfElements(); ++i) {
+            const G4Element* element = (*elements)[i];
+            if (element->GetZasInt() != targetZ) continue;
+            hasTarget = true;
+            G4double perAtom = protonRecoil
+                ? store->GetElasticCrossSectionPerAtom(G4Neutron::Definition(), energy, element, material)
+                : store->GetInelasticCrossSectionPerAtom(G4Neutron::Definition(), energy, element, material);
+            sigma += atomDensities[i] * perAtom;
+        }
+        channel.logSigma.push_back(std::log(std::max(sigma, DBL_MIN)));
+    }
+    if (!hasTarget) {
+        G4cerr << "WARNING: " << material->GetName() << " has no Z=" << targetZ
+               << " target; fast scintillator reactions disabled for it" << G4endl;
+        channel.logSigma.clear();
+        return nullptr;
+    }
+    G4cout << "ScintReactionModel: " << (protonRecoil ? "n-p elastic" : "6Li(n,t)alpha") << " table for "
+           << material->GetName() << ", " << G4BestUnit(channel.emin, "Energy") << "- "
+           << G4BestUnit(channel.emax, "Energy") << G4endl;
+    return &channel;
+}
+
+G4bool ScintReactionModel::ModelTrigger(const G4FastTrack& fastTrack) {
+    if (!Sim::fastScintModels) return false;
+    const G4Track* track = fastTrack.GetPrimaryTrack();
+    const Channel* channel = channelFor(track->GetMaterial());
+    G4double energy = track->GetKineticEnergy();
+    return channel && energy >= channel->emin && energy <= channel->emax;
+}
+
+void ScintReactionModel::DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep) {
+    const G4Track* track = fastTrack.GetPrimaryTrack();
+    const Channel* channel = channelFor(track->GetMaterial());
+    G4double energy = track->GetKineticEnergy();
+    G4ThreeVector direction = track->GetMomentumDirection();
+
+    // Free flight to the next interaction of the channel, or to the envelope exit
+    G4double exitDistance = fastTrack.GetEnvelopeSolid()->DistanceToOut(
+        fastTrack.GetPrimaryTrackLocalPosition(), fastTrack.GetPrimaryTrackLocalDirection());
+    G4double sigma = channel->Sigma(energy);
+    G4double distance = sigma > 0 ? -std::log(1. - G4UniformRand()) / sigma : DBL_MAX;
+    G4bool interacts = distance < exitDistance;
+    if (!interacts) distance = exitDistance;
+
+    G4ThreeVector vertex = track->GetPosition() + distance * direction;
+    G4double time = track->GetGlobalTime() + distance / track->GetVelocity();
+    fastStep.ProposePrimaryTrackFinalPosition(vertex, false);
+    fastStep.ProposePrimaryTrackFinalTime(time);
+    fastStep.ProposePrimaryTrackPathLength(distance);
+    if (!interacts) return;
+
+    // Non-relativistic two-body kinematics, isotropic in the centre of mass
+    G4double neutronMass = G4Neutron::Definition()->GetPDGMass();
+    G4ThreeVector neutronVelocity = direction * std::sqrt(2. * energy / neutronMass);
+    G4ThreeVector axis = G4RandomDirection();
+    G4double weight = track->GetWeight();
+
+    if (channel->type == MaterialBuilder::ScintType::EJ200) {
+        G4double protonMass = G4Proton::Definition()->GetPDGMass();
+        G4ThreeVector centre = neutronVelocity * (neutronMass / (neutronMass + protonMass));
+        G4ThreeVector relative = axis * (neutronVelocity.mag() * protonMass / (neutronMass + protonMass));
+        G4ThreeVector scattered = centre + relative;
+        G4ThreeVector recoil = centre - relative * (neutronMass / protonMass);
+        fastStep.ProposePrimaryTrackFinalKineticEnergyAndDirection(0.5 * neutronMass * scattered.mag2(), scattered.unit(), false);
+        fastStep.SetNumberOfSecondaryTracks(1);
+        createProduct(fastStep, G4Proton::Definition(), protonMass, recoil, vertex, time, weight);
+    } else {
+        G4double lithiumMass = G4IonTable::GetIonTable()->GetIonMass(3, 6);
+        G4double tritonMass = G4Triton::Definition()->GetPDGMass();
+        G4double alphaMass = G4Alpha::Definition()->GetPDGMass();
+        G4double q = neutronMass + lithiumMass - tritonMass - alphaMass; // 4.78 MeV
+        G4ThreeVector centre = neutronVelocity * (neutronMass / (neutronMass + lithiumMass));
+        G4double available = 0.5 * neutronMass * lithiumMass / (neutronMass + lithiumMass) * neutronVelocity.mag2() + q;
+        G4double momentum = std::sqrt(2. * available * tritonMass * alphaMass / (tritonMass + alphaMass));
+        fastStep.KillPrimaryTrack();
+        fastStep.SetNumberOfSecondaryTracks(2);
+        createProduct(fastStep, G4Triton::Definition(), tritonMass, centre + axis * (momentum / tritonMass), vertex, time, weight);
+        createProduct(fastStep, G4Alpha::Definition(), alphaMass, centre - axis * (momentum / alphaMass), vertex, time, weight);
+    }
+}
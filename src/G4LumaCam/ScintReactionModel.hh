@@ -0,0 +1,36 @@
+#ifndef SCINT_REACTION_MODEL_HH
+#define SCINT_REACTION_MODEL_HH
+
+#include "G4VFastSimulationModel.hh"
+#include "MaterialBuilder.hh"
+#include <map>
+#include <vector>
+
+// Fast simulation of the light-producing neutron channel of the scintillator, chosen by
+// MaterialBuilder::ScintType: n-p elastic scattering in EJ200 and 6Li(n,t)alpha in GS20.
+// Inside ScintLog the neutron flies straight between interactions of that channel, sampled
+// from a macroscopic cross-section table; other channels are neglected. Products get analytic
+// two-body kinematics (isotropic in the centre of mass) and are left to QuenchedLightModel.
+// Enabled with /lumacam/fastScintModels; compare against HP with Simulate.compare_light_yield.
+class ScintReactionModel : public G4VFastSimulationModel {
+public:
+    ScintReactionModel(const G4String& name, G4Region* envelope);
+
+    G4bool IsApplicable(const G4ParticleDefinition& particle) override;
+    G4bool ModelTrigger(const G4FastTrack& fastTrack) override;
+    void DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep) override;
+
+private:
+    struct Channel {
+        MaterialBuilder::ScintType type;
+        G4double emin, emax; // Validity range of the table
+        std::vector<G4double> logSigma; // log of the macroscopic cross section (1/mm) on a log energy grid
+        G4double Sigma(G4double energy) const;
+    };
+
+    const Channel* channelFor(const G4Material* material);
+
+    std::map<const G4Material*, Channel> channels; // Built on first use, once hadronic data is loaded
+};
+
+#endif
@@ -2,8 +2,10 @@
 #include <ctime>
 #include "G4ios.hh"
 #include <cmath>
+#include <cstdint>
 #include <filesystem>
 #include "Randomize.hh"
+#include "G4Exception.hh"
 
 namespace Sim {
     G4String outputFileName = "sim_data.csv";
@@ -21,6 +23,52 @@ namespace Sim {
     G4double FREQ = 0.0; // Default: no pulsed structure
     std::vector<G4double> pulseTimes; // Trigger times in ns
     std::vector<G4int> neutronsPerPulse; // Neutrons per pulse
+    G4bool writePhotons = true;
+    G4bool lensAcceptance = true;
+    G4bool neutronPlane = false;
+    G4bool fastScintModels = false;
+    G4bool rangeTableLight = false;
+    G4String photonFormat = "csv";
+    G4double CODEC_POSITION_GRID = 1.0 * um;
+    G4double CODEC_TIME_TICK = 1.0 * ps;
+    G4int CODEC_BLOCK_PHOTONS = 65536;
+    G4double CODEC_TILE_SIZE = 0.0 * mm;
+    G4int DETAIL_PRESCALE = 1;
+    G4bool neutronSummary = false;
+    G4String notifyFile = "";
+    G4bool frameOutput = false;
+    G4int FRAME_NX = 512;
+    G4int FRAME_NY = 512;
+    G4double FRAME_FOV = 0.0;
+    G4int FRAME_PULSES = 1;
+    G4double FRAME_EXPOSURE = 0.0;
+    G4int FRAME_MAX_ACTIVE = 64;
+    G4bool tofCubeOutput = false;
+    G4int TOF_CUBE_NX = 256;
+    G4int TOF_CUBE_NY = 256;
+    G4int TOF_CUBE_BINS = 1000;
+    G4double TOF_CUBE_FOV = 0.0;
+    G4double TOF_CUBE_MIN = 1.0 * us;
+    G4double TOF_CUBE_MAX = 50.0 * ms;
+    G4bool TOF_CUBE_LOG = true;
+    std::vector<G4double> tomoAngles;
+    G4int TOMO_WORKER_INDEX = 0;
+    G4int TOMO_WORKER_COUNT = 1;
+    G4String monitorMode = "volume";
+    G4String opticalFastPath = "off";
+    G4String importanceMode = "none";
+    G4String importanceMapFile = "";
+    G4String reweightFile = "";
+    G4double IMPORTANCE_EDGE_WIDTH = 2.0 * mm;
+    G4double IMPORTANCE_EDGE_BOOST = 10.0;
+    G4double SAMPLE_KILL_ENERGY = 0.0;
+    G4double SAMPLE_KILL_TIME = 0.0;
+    G4double SCINT_KILL_ENERGY = 0.0;
+    G4double SCINT_KILL_TIME = 0.0;
+    G4double HOUSING_KILL_ENERGY = 0.0;
+    G4double HOUSING_KILL_TIME = 0.0;
+    G4int NEUTRON_MAX_SCATTERS = 0;
+    G4double NEUTRON_ROULETTE_SURVIVAL = 1.0;
 
     void SetScintThickness(G4double thickness) {
         if (thickness > 0) {
@@ -49,6 +97,60 @@ namespace Sim {
         }
     }
 
+    std::filesystem::path OutputDirectory(const G4String& name) {
+        std::filesystem::path dir = std::filesystem::current_path() / std::string(name);
+        try {
+            std::filesystem::create_directories(dir);
+        } catch (const std::filesystem::filesystem_error& e) {
+            G4cerr << "ERROR: Failed to create directory " << dir << ": " << e.what() << G4endl;
+            G4Exception("Sim::OutputDirectory()", "IO001",
+                        FatalException, ("Cannot create " + name + " directory").c_str());
+        }
+        return dir;
+    }
+
+    G4String OutputBaseName() {
+        G4String fileName = outputFileName;
+        size_t csvPos = fileName.find(".csv");
+        if (csvPos != G4String::npos) {
+            fileName = fileName.substr(0, csvPos);
+        }
+        return fileName;
+    }
+
+    G4bool BinaryPhotonOutput() {
+        return photonFormat == "binary";
+    }
+
+    G4bool DetailedEvent(G4int eventId) {
+        if (DETAIL_PRESCALE <= 1) return true;
+        // splitmix64 finalizer, so the selected subset does not follow event ID patterns
+        uint64_t h = static_cast<uint64_t>(eventId) + 0x9E3779B97F4A7C15ULL;
+        h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+        h ^= h >> 31;
+        return h % static_cast<uint64_t>(DETAIL_PRESCALE) == 0;
+    }
+
+    G4bool ExitFaceMonitor() {
+        return monitorMode == "exitFace";
+    }
+
+    G4bool InLensWindow(const G4ThreeVector& exitPos, const G4ThreeVector& dir) {
+        // Straight-line projection 500 mm downstream onto the +-27.5 mm lens aperture
+        G4double lensX = exitPos.x() / mm + 500. * dir.x();
+        G4double lensY = exitPos.y() / mm + 500. * dir.y();
+        return lensX > -27.5 && lensX < 27.5 && lensY > -27.5 && lensY < 27.5;
+    }
+
+    G4bool ImportanceSamplingEnabled() {
+        return importanceMode == "map" || importanceMode == "edge";
+    }
+
+    G4bool WeightedOutput() {
+        return ImportanceSamplingEnabled() || NEUTRON_ROULETTE_SURVIVAL < 1.0;
+    }
+
     void ComputePulseStructure(G4int totalNeutrons) {
         pulseTimes.clear();
         neutronsPerPulse.clear();
@@ -3,6 +3,8 @@
 
 #include "G4SystemOfUnits.hh"
 #include "G4String.hh"
+#include "G4ThreeVector.hh"
+#include <filesystem>
 #include <random>
 #include <vector>
 
@@ -24,11 +26,62 @@ namespace Sim {
     extern G4double FREQ; // Pulse frequency in Hz
     extern std::vector<G4double> pulseTimes; // Trigger times for pulses in ns
     extern std::vector<G4int> neutronsPerPulse; // Neutrons per pulse
+    extern G4bool writePhotons; // Per-photon output in SimPhotons
+    extern G4bool lensAcceptance; // Keep only photons heading into the lens window
+    extern G4bool neutronPlane; // No optical physics; record neutrons entering ScintPhys instead (--neutron-plane)
+    extern G4bool fastScintModels; // Fast n-p / 6Li(n,t) reaction and quenched-light models in ScintLog
+    extern G4bool rangeTableLight; // Quenched light from range tables for every p, t and alpha in ScintLog
+    extern G4String photonFormat; // Per-photon file format: "csv" or "binary" (PhotonCodec)
+    extern G4double CODEC_POSITION_GRID; // Binary position quantization step
+    extern G4double CODEC_TIME_TICK; // Binary time quantization step
+    extern G4int CODEC_BLOCK_PHOTONS; // Photons per indexed binary block
+    extern G4double CODEC_TILE_SIZE; // Spatial tile width of binary blocks (0 = untiled)
+    extern G4int DETAIL_PRESCALE; // Write photon records for 1 in DETAIL_PRESCALE events
+    extern G4bool neutronSummary; // Per-neutron summary rows for every event in SimNeutrons
+    extern G4String notifyFile; // JSON-lines file (or FIFO, /dev/fd/N) announcing closed batch files
+    extern G4bool frameOutput; // Sparse per-exposure frames in SimFrames
+    extern G4int FRAME_NX, FRAME_NY; // Frame pixel grid
+    extern G4double FRAME_FOV; // Frame field of view on the exit face (0 uses SCINT_SIZE)
+    extern G4int FRAME_PULSES; // Pulses integrated per frame
+    extern G4double FRAME_EXPOSURE; // Exposure from frame start (0 for the whole frame period)
+    extern G4int FRAME_MAX_ACTIVE; // Open frames kept in memory before the oldest is forced out
+    extern G4bool tofCubeOutput; // Online (x, y, TOF) cube in SimTOF
+    extern G4int TOF_CUBE_NX, TOF_CUBE_NY, TOF_CUBE_BINS;
+    extern G4double TOF_CUBE_FOV; // Cube field of view on the exit face (0 uses SCINT_SIZE)
+    extern G4double TOF_CUBE_MIN, TOF_CUBE_MAX; // TOF range relative to the pulse time
+    extern G4bool TOF_CUBE_LOG; // Log-spaced TOF bins
+    extern std::vector<G4double> tomoAngles; // Sample rotation per tomography sub-run
+    extern G4int TOMO_WORKER_INDEX, TOMO_WORKER_COUNT; // This process runs angles with index % count == worker index
+    extern G4String monitorMode; // Escaping photon scoring: "volume" (MonitorPhys) or "exitFace"
+    extern G4String opticalFastPath; // Trivial optical surfaces: "off", "on" (shortcut) or "check" (against the stock process)
+    extern G4String importanceMode; // Source importance sampling: "none", "map" or "edge"
+    extern G4String importanceMapFile; // Text file with a 2D importance map over the source plane
+    extern G4double IMPORTANCE_EDGE_WIDTH; // Half-width of the boosted band around the sample edge
+    extern G4double IMPORTANCE_EDGE_BOOST; // Relative importance inside the edge band
+    extern G4String reweightFile; // "energy weight" table reweighting frames and TOF cube to a target spectrum
+
+    // Neutron termination thresholds per region (0 disables a threshold)
+    extern G4double SAMPLE_KILL_ENERGY; // Kill neutrons below this kinetic energy in the sample
+    extern G4double SAMPLE_KILL_TIME; // Kill neutrons in the sample this long after the event trigger (vertex T0)
+    extern G4double SCINT_KILL_ENERGY;
+    extern G4double SCINT_KILL_TIME;
+    extern G4double HOUSING_KILL_ENERGY; // Everything outside sample and scintillator
+    extern G4double HOUSING_KILL_TIME;
+    extern G4int NEUTRON_MAX_SCATTERS; // Kill neutrons after this many interactions (0 disables)
+    extern G4double NEUTRON_ROULETTE_SURVIVAL; // Russian roulette survival probability outside the scintillator (1 disables)
 
     void SetScintThickness(G4double thickness);
     void SetSampleThickness(G4double thickness);
     void SetSampleWidth(G4double width);
     void ComputePulseStructure(G4int totalNeutrons); // Compute pulse times and neutrons per pulse
+    G4bool ExitFaceMonitor();
+    G4bool InLensWindow(const G4ThreeVector& exitPos, const G4ThreeVector& dir); // Photon leaving the exit face reaches the lens
+    std::filesystem::path OutputDirectory(const G4String& name); // Create ./name if needed
+    G4String OutputBaseName(); // outputFileName without the .csv extension
+    G4bool BinaryPhotonOutput();
+    G4bool DetailedEvent(G4int eventId); // Deterministic 1-in-DETAIL_PRESCALE selection by event ID hash
+    G4bool ImportanceSamplingEnabled();
+    G4bool WeightedOutput(); // True when records need a statistical weight column
 }
 
 #endif
\ No newline at end of file
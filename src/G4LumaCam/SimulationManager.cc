@@ -1,16 +1,71 @@
 #include "SimulationManager.hh"
 #include "G4Run.hh"
+#include "G4SDManager.hh"
 #include "G4RunManager.hh"
 #include "G4SystemOfUnits.hh"
 #include "ParticleGenerator.hh"
 #include "G4UnitsTable.hh"
 #include "SimConfig.hh"
+#include "PerfCounters.hh"
+#include "G4Neutron.hh"
+#include "G4OpticalPhoton.hh"
+#include "G4PhysicalVolumeStore.hh"
+#include "G4Step.hh"
+#include "G4Event.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4VProcess.hh"
+#include "FastBoundaryProcess.hh"
+#include "G4OpProcessSubType.hh"
+#include "G4ProcessManager.hh"
+#include "G4LogicalVolumeStore.hh"
+#include "G4Material.hh"
+#include "Randomize.hh"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace {
+    const char* kFateNames[] = {"bulk_absorption", "tape_absorption", "housing_absorption", "other_absorption",
+                                "side_escape", "outside_lens", "reached_monitor", "other"};
+}
 
 SimulationManager::SimulationManager() 
-    : processor(new EventProcessor("Tracker")), eventCounter(0), totalNeutrons(0) {}
+    : processor(new EventProcessor("Tracker")), eventCounter(0), totalNeutrons(0),
+      opticalPhotons(0), opticalSteps(0), eventT0(0.), samplePhys(nullptr), scintPhys(nullptr),
+      blackSideLog(nullptr), blackBackLog(nullptr), lShapeLog(nullptr), boundaryProcess(nullptr),
+      scintSD(nullptr) {
+    resetNeutronKillCounters();
+    for (auto& fate : opticalFates) fate.fill(0);
+}
 
 void SimulationManager::BeginOfRunAction(const G4Run* run) {
     eventCounter = 0;
+    resetNeutronKillCounters();
+    opticalPhotons = 0;
+    opticalSteps = 0;
+    for (auto& fate : opticalFates) fate.fill(0);
+    
+    // Cache volumes so the stepping action can classify neutron and photon steps by pointer
+    G4PhysicalVolumeStore* physVolStore = G4PhysicalVolumeStore::GetInstance();
+    samplePhys = physVolStore->GetVolume("SamplePhys", false);
+    scintPhys = physVolStore->GetVolume("ScintPhys", false);
+    G4LogicalVolumeStore* logVolStore = G4LogicalVolumeStore::GetInstance();
+    blackSideLog = logVolStore->GetVolume("black_side_log", false);
+    blackBackLog = logVolStore->GetVolume("black_back_log", false);
+    lShapeLog = logVolStore->GetVolume("LShapeLog", false);
+    
+    boundaryProcess = nullptr;
+    G4ProcessVector* processes = G4OpticalPhoton::OpticalPhoton()->GetProcessManager()->GetProcessList();
+    for (size_t i = 0; i < processes->size(); ++i) {
+        if ((*processes)[i]->GetProcessName() == "OpBoundary") {
+            boundaryProcess = dynamic_cast<FastBoundaryProcess*>((*processes)[i]);
+            break;
+        }
+    }
+    if (boundaryProcess) boundaryProcess->ResetReport();
+    
+    scintSD = findEventProcessor();
+    if (scintSD) scintSD->BeginOfRun(run->GetRunID());
     
     G4cout << "\n################################################" << G4endl;
     G4cout << "### Run " << run->GetRunID() << " Starting ###" << G4endl;
@@ -48,6 +103,9 @@ void SimulationManager::BeginOfRunAction(const G4Run* run) {
             G4cout << "\nRunning in continuous beam mode (FLUX=" << Sim::FLUX 
                    << ", FREQ=" << Sim::FREQ << ")" << G4endl;
         }
+        
+        // Importance map depends on the GPS plane and sample geometry set by the macro
+        generator->PrepareImportanceSampling();
     } else {
         G4cerr << "ERROR: Could not find ParticleGenerator!" << G4endl;
     }
@@ -59,8 +117,27 @@ void SimulationManager::EndOfRunAction(const G4Run* run) {
     G4cout << "\n################################################" << G4endl;
     G4cout << "### Run " << run->GetRunID() << " Ended ###" << G4endl;
     G4cout << "Total events processed: " << eventCounter << G4endl;
+    if (opticalPhotons > 0) {
+        G4cout << "Optical photons tracked: " << opticalPhotons << ", steps per photon: "
+               << static_cast<G4double>(opticalSteps) / opticalPhotons
+               << " (monitor mode: " << Sim::monitorMode << ")" << G4endl;
+    }
+    PerfCounters& perf = PerfCounters::Instance();
+    perf.Push(PerfCounters::kOutput);
+    printOpticalLossSummary();
+    writeOpticalLosses(run->GetRunID());
+    printNeutronKillSummary();
+    if (boundaryProcess) boundaryProcess->PrintReport();
+    
+    if (EventProcessor* sd = findEventProcessor()) sd->EndOfRun(run->GetRunID());
+    perf.Pop();
+    perf.Report(run->GetRunID());
     G4cout << "################################################\n" << G4endl;
     
+    // Work until the next run's first event is that run's initialization
+    perf.Reset();
+    perf.SetPhase(PerfCounters::kInit);
+    
     // Clear pulse structure for next run
     Sim::pulseTimes.clear();
     Sim::neutronsPerPulse.clear();
@@ -73,7 +150,142 @@ void SimulationManager::SetTotalNeutrons(G4int nNeutrons) {
 
 SimulationManager::EventHandler::EventHandler(SimulationManager* mgr) : manager(mgr) {}
 
-void SimulationManager::EventHandler::BeginOfEventAction(const G4Event*) {}
+EventProcessor* SimulationManager::findEventProcessor() const {
+    // Online accumulators live in the scintillator SD registered by GeometryConstructor
+    return dynamic_cast<EventProcessor*>(
+        G4SDManager::GetSDMpointer()->FindSensitiveDetector("EventProcessor", false));
+}
+
+void SimulationManager::resetNeutronKillCounters() {
+    for (G4int r = 0; r < kNumRegions; ++r) {
+        killCounters.energyKills[r] = 0;
+        killCounters.timeKills[r] = 0;
+    }
+    killCounters.scatterKills = 0;
+    killCounters.rouletteKills = 0;
+    killCounters.rouletteSurvivors = 0;
+}
+
+void SimulationManager::printNeutronKillSummary() const {
+    const char* regionNames[kNumRegions] = {"sample", "scintillator", "housing"};
+    G4int totalKills = killCounters.scatterKills + killCounters.rouletteKills;
+    for (G4int r = 0; r < kNumRegions; ++r) {
+        totalKills += killCounters.energyKills[r] + killCounters.timeKills[r];
+    }
+    if (totalKills == 0 && killCounters.rouletteSurvivors == 0) return;
+
+    G4cout << "Neutron termination:" << G4endl;
+    for (G4int r = 0; r < kNumRegions; ++r) {
+        G4cout << "  " << regionNames[r] << ": " << killCounters.energyKills[r]
+               << " below energy limit, " << killCounters.timeKills[r]
+               << " beyond time limit" << G4endl;
+    }
+    G4cout << "  Max scatters reached: " << killCounters.scatterKills << G4endl;
+    G4cout << "  Russian roulette: " << killCounters.rouletteKills << " killed, "
+           << killCounters.rouletteSurvivors << " survived" << G4endl;
+}
+
+void SimulationManager::countOpticalFate(const G4Step* step) {
+    G4Track* track = step->GetTrack();
+    const G4StepPoint* preStep = step->GetPreStepPoint();
+    const G4StepPoint* postStep = step->GetPostStepPoint();
+    G4bool dying = track->GetTrackStatus() != fAlive;
+    G4bool leavingScint = preStep->GetPhysicalVolume() == scintPhys && postStep->GetStepStatus() == fGeomBoundary;
+    if (!dying && !leavingScint) return;
+    if (escapedPhotons.count(track->GetTrackID())) return;
+
+    G4OpBoundaryProcessStatus status = boundaryProcess ? boundaryProcess->GetStatus() : Undefined;
+    OpticalFate fate;
+    if (leavingScint && (status == Transmission || status == FresnelRefraction)) {
+        // Counted where it leaves the scintillator, whatever happens to it afterwards
+        const G4ThreeVector& dir = postStep->GetMomentumDirection();
+        G4bool exitFace = dir.z() > 0 && postStep->GetPosition().z() >= Sim::SCINT_THICKNESS - 1 * um;
+        fate = !exitFace ? kSideEscape
+             : Sim::InLensWindow(postStep->GetPosition(), dir) ? kReachedMonitor : kOutsideLens;
+        if (!dying) escapedPhotons.insert(track->GetTrackID());
+    } else if (!dying) {
+        return;
+    } else {
+        const G4VProcess* process = postStep->GetProcessDefinedStep();
+        if (process && process->GetProcessSubType() == fOpAbsorption) {
+            fate = (preStep->GetPhysicalVolume() == scintPhys) ? kBulkAbsorption : kOtherAbsorption;
+        } else if (postStep->GetStepStatus() == fGeomBoundary && (status == Absorption || status == Detection)) {
+            // Skin surfaces belong to either side of the boundary
+            const G4LogicalVolume* preLog = preStep->GetPhysicalVolume()->GetLogicalVolume();
+            const G4LogicalVolume* postLog = postStep->GetPhysicalVolume() ?
+                                             postStep->GetPhysicalVolume()->GetLogicalVolume() : nullptr;
+            if (preLog == blackSideLog || preLog == blackBackLog || postLog == blackSideLog || postLog == blackBackLog) {
+                fate = kTapeAbsorption;
+            } else if (preLog == lShapeLog || postLog == lShapeLog) {
+                fate = kHousingAbsorption;
+            } else {
+                fate = kOtherAbsorption;
+            }
+        } else {
+            fate = kOtherLoss;
+        }
+    }
+
+    // Depth of the emission point, from the scintillator back face (z = 0) to the exit face
+    G4double depth = track->GetVertexPosition().z() / Sim::SCINT_THICKNESS;
+    G4int bin = std::clamp(static_cast<G4int>(std::floor(depth * kLossDepthBins)), 0, kLossDepthBins - 1);
+    opticalFates[fate][bin]++;
+}
+
+void SimulationManager::printOpticalLossSummary() const {
+    G4long totals[kNumFates];
+    G4long total = 0;
+    for (G4int f = 0; f < kNumFates; ++f) {
+        totals[f] = 0;
+        for (G4long count : opticalFates[f]) totals[f] += count;
+        total += totals[f];
+    }
+    if (total == 0) return;
+
+    G4cout << "Optical photon fates (" << scintillatorName() << "):" << G4endl;
+    for (G4int f = 0; f < kNumFates; ++f) {
+        G4cout << "  " << kFateNames[f] << ": " << totals[f] << " ("
+               << 100. * totals[f] / total << "%)" << G4endl;
+    }
+}
+
+// Depth-resolved counts for offline comparison of scintillators and thicknesses
+void SimulationManager::writeOpticalLosses(G4int runId) const {
+    G4long total = 0;
+    for (const auto& fate : opticalFates) {
+        for (G4long count : fate) total += count;
+    }
+    if (total == 0) return;
+
+    std::filesystem::path lossPath = Sim::OutputDirectory("SimLosses") /
+        std::string(Sim::OutputBaseName() + "_losses_" + std::to_string(runId) + ".csv");
+    std::ofstream lossFile(lossPath);
+    if (!lossFile.is_open()) {
+        G4cerr << "ERROR: Failed to open file: " << lossPath << G4endl;
+        return;
+    }
+    G4String scintName = scintillatorName();
+    lossFile << "scintillator,depth_min_mm,depth_max_mm,cause,photons\n";
+    G4double binWidth = Sim::SCINT_THICKNESS / mm / kLossDepthBins;
+    for (G4int f = 0; f < kNumFates; ++f) {
+        for (G4int b = 0; b < kLossDepthBins; ++b) {
+            lossFile << scintName << "," << b * binWidth << "," << (b + 1) * binWidth << ","
+                     << kFateNames[f] << "," << opticalFates[f][b] << "\n";
+        }
+    }
+}
+
+G4String SimulationManager::scintillatorName() const {
+    return scintPhys ? scintPhys->GetLogicalVolume()->GetMaterial()->GetName() : "unknown";
+}
+
+void SimulationManager::EventHandler::BeginOfEventAction(const G4Event* event) {
+    PerfCounters::Instance().SetPhase(PerfCounters::kEventLoop);
+    const G4PrimaryVertex* vertex = event->GetPrimaryVertex();
+    manager->eventT0 = vertex ? vertex->GetT0() : 0.;
+    manager->neutronScatters.clear();
+    manager->escapedPhotons.clear();
+}
 
 void SimulationManager::EventHandler::EndOfEventAction(const G4Event*) {
     manager->eventCounter++;
@@ -82,4 +294,76 @@ void SimulationManager::EventHandler::EndOfEventAction(const G4Event*) {
     if (manager->eventCounter % 100 == 0) {
         G4cout << "Processed " << manager->eventCounter << " events..." << G4endl;
     }
+}
+
+SimulationManager::SteppingHandler::SteppingHandler(SimulationManager* mgr) : manager(mgr) {}
+
+void SimulationManager::SteppingHandler::UserSteppingAction(const G4Step* step) {
+    G4Track* track = step->GetTrack();
+    const G4ParticleDefinition* particle = track->GetDefinition();
+    // Only neutrons reach the neutron plane; nothing else needs tracking
+    if (Sim::neutronPlane && particle != G4Neutron::Definition()) {
+        track->SetTrackStatus(fStopAndKill);
+        return;
+    }
+    if (particle == G4OpticalPhoton::Definition()) {
+        manager->opticalSteps++;
+        if (track->GetCurrentStepNumber() == 1) manager->opticalPhotons++;
+        manager->countOpticalFate(step);
+        return;
+    }
+    if (particle != G4Neutron::Definition()) return;
+    if (track->GetTrackStatus() != fAlive) return;
+
+    const G4VPhysicalVolume* volume = step->GetPreStepPoint()->GetPhysicalVolume();
+    NeutronRegion region = kHousing;
+    if (volume == manager->samplePhys) region = kSample;
+    else if (volume == manager->scintPhys) region = kScint;
+
+    G4double energyLimit = (region == kSample) ? Sim::SAMPLE_KILL_ENERGY
+                         : (region == kScint) ? Sim::SCINT_KILL_ENERGY : Sim::HOUSING_KILL_ENERGY;
+    G4double timeLimit = (region == kSample) ? Sim::SAMPLE_KILL_TIME
+                       : (region == kScint) ? Sim::SCINT_KILL_TIME : Sim::HOUSING_KILL_TIME;
+
+    // Same semantics as G4NeutronKiller, but resolved per region
+    if (energyLimit > 0 && track->GetKineticEnergy() < energyLimit) {
+        track->SetTrackStatus(fStopAndKill);
+        manager->killCounters.energyKills[region]++;
+        return;
+    }
+    if (timeLimit > 0 && track->GetGlobalTime() - manager->eventT0 > timeLimit) {
+        track->SetTrackStatus(fStopAndKill);
+        manager->killCounters.timeKills[region]++;
+        return;
+    }
+
+    // Only interactions count towards scatters and trigger roulette
+    const G4VProcess* process = step->GetPostStepPoint()->GetProcessDefinedStep();
+    if (!process || process->GetProcessType() == fTransportation) return;
+    // A fast-simulation step that only carries the neutron to the scintillator exit is not one
+    if (process->GetProcessType() == fParameterisation &&
+        step->GetPostStepPoint()->GetMomentum() == step->GetPreStepPoint()->GetMomentum()) return;
+
+    // SampleLog has no sensitive detector, so the scintillator SD learns of sample interactions here
+    if (region == kSample && track->GetParentID() == 0 && manager->scintSD &&
+        step->GetPostStepPoint()->GetMomentum() != step->GetPreStepPoint()->GetMomentum()) {
+        manager->scintSD->RecordSampleInteraction(step->GetPostStepPoint()->GetPosition());
+    }
+
+    if (Sim::NEUTRON_MAX_SCATTERS > 0 &&
+        ++manager->neutronScatters[track->GetTrackID()] >= Sim::NEUTRON_MAX_SCATTERS) {
+        track->SetTrackStatus(fStopAndKill);
+        manager->killCounters.scatterKills++;
+        return;
+    }
+
+    if (region != kScint && Sim::NEUTRON_ROULETTE_SURVIVAL < 1.0) {
+        if (G4UniformRand() >= Sim::NEUTRON_ROULETTE_SURVIVAL) {
+            track->SetTrackStatus(fStopAndKill);
+            manager->killCounters.rouletteKills++;
+        } else {
+            track->SetWeight(track->GetWeight() / Sim::NEUTRON_ROULETTE_SURVIVAL);
+            manager->killCounters.rouletteSurvivors++;
+        }
+    }
 }
\ No newline at end of file
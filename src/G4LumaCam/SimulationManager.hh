@@ -3,7 +3,15 @@
 
 #include "G4UserRunAction.hh"
 #include "G4UserEventAction.hh"
+#include "G4UserSteppingAction.hh"
+#include "G4VPhysicalVolume.hh"
 #include "EventProcessor.hh"
+#include <array>
+#include <unordered_map>
+#include <unordered_set>
+
+class FastBoundaryProcess;
+class G4LogicalVolume;
 
 class SimulationManager : public G4UserRunAction {
 public:
@@ -21,10 +29,67 @@ public:
         SimulationManager* manager;
     };
 
+    // Counts optical steps and photon fates, terminates neutrons according to the
+    // /lumacam/neutronKill/ settings and reports sample interactions to the scintillator SD
+    class SteppingHandler : public G4UserSteppingAction {
+    public:
+        SteppingHandler(SimulationManager* mgr);
+        void UserSteppingAction(const G4Step*) override;
+    private:
+        SimulationManager* manager;
+    };
+
 private:
+    enum NeutronRegion { kSample, kScint, kHousing, kNumRegions };
+
+    struct NeutronKillCounters {
+        G4int energyKills[kNumRegions];
+        G4int timeKills[kNumRegions];
+        G4int scatterKills;
+        G4int rouletteKills;
+        G4int rouletteSurvivors;
+    };
+
+    // Where optical photons end up; each photon is counted once
+    enum OpticalFate {
+        kBulkAbsorption,    // OpAbsorption inside the scintillator
+        kTapeAbsorption,    // Absorbed at BlackTapeSurface (sides and back)
+        kHousingAbsorption, // Absorbed at the DarkLShape housing walls
+        kOtherAbsorption,   // OpAbsorption outside the scintillator or other surfaces
+        kSideEscape,        // Left the scintillator through a face other than the exit face
+        kOutsideLens,       // Left the exit face but misses the lens window
+        kReachedMonitor,    // Left the exit face towards the lens window
+        kOtherLoss,         // Left the world or killed for other reasons
+        kNumFates
+    };
+    static constexpr G4int kLossDepthBins = 10; // Generation depth bins across the scintillator
+
+    EventProcessor* findEventProcessor() const;
+    void resetNeutronKillCounters();
+    void printNeutronKillSummary() const;
+    void countOpticalFate(const G4Step* step);
+    void printOpticalLossSummary() const;
+    void writeOpticalLosses(G4int runId) const; // SimLosses/<base>_losses_<run>.csv
+    G4String scintillatorName() const;
+
     EventProcessor* processor;
     G4int eventCounter;
     G4int totalNeutrons;
+
+    NeutronKillCounters killCounters;
+    G4long opticalPhotons; // Optical photons tracked this run
+    G4long opticalSteps; // Steps taken by those photons
+    std::unordered_map<G4int, G4int> neutronScatters; // Interactions per neutron track in the current event
+    G4double eventT0; // Primary vertex time (pulse trigger) of the current event; kill times count from here
+    std::array<std::array<G4long, kLossDepthBins>, kNumFates> opticalFates;
+    std::unordered_set<G4int> escapedPhotons; // Photons already counted as leaving the scintillator
+    const G4VPhysicalVolume* samplePhys;
+    const G4VPhysicalVolume* scintPhys;
+    const G4LogicalVolume* blackSideLog;
+    const G4LogicalVolume* blackBackLog;
+    const G4LogicalVolume* lShapeLog;
+    FastBoundaryProcess* boundaryProcess;
+    EventProcessor* scintSD; // Scintillator SD of the current run; sample interactions are passed to it
 };
 
 #endif
\ No newline at end of file
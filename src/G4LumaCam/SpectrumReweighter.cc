@@ -0,0 +1,83 @@
+#include "SpectrumReweighter.hh"
+#include "SimConfig.hh"
+#include "G4ios.hh"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+SpectrumReweighter::SpectrumReweighter() : sum(0.), sumSquares(0.), neutrons(0) {}
+
+void SpectrumReweighter::Reset() {
+    energies.clear();
+    weights.clear();
+    sum = sumSquares = 0.;
+    neutrons = 0;
+    if (Sim::reweightFile.empty()) return;
+    if (!load(Sim::reweightFile)) {
+        energies.clear();
+        weights.clear();
+        G4cerr << "ERROR: Spectrum reweighting disabled" << G4endl;
+    }
+}
+
+G4bool SpectrumReweighter::load(const G4String& fileName) {
+    std::ifstream table(fileName);
+    if (!table.is_open()) {
+        G4cerr << "ERROR: Cannot open reweight table " << fileName << G4endl;
+        return false;
+    }
+
+    // Format: '#' comments, then "energy_MeV weight" rows with ascending positive energies
+    std::string line;
+    while (std::getline(table, line)) {
+        size_t hashPos = line.find('#');
+        if (hashPos != std::string::npos) line = line.substr(0, hashPos);
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream values(line);
+        G4double energy, weight;
+        if (!(values >> energy)) continue;
+        if (!(values >> weight) || energy <= 0 || weight < 0 ||
+            (!energies.empty() && energy <= energies.back())) {
+            G4cerr << "ERROR: Reweight table " << fileName << " needs ascending positive energies "
+                   << "and non-negative weights, got: " << line << G4endl;
+            return false;
+        }
+        energies.push_back(energy);
+        weights.push_back(weight);
+    }
+    if (energies.size() < 2) {
+        G4cerr << "ERROR: Reweight table " << fileName << " has fewer than two points" << G4endl;
+        return false;
+    }
+    return true;
+}
+
+G4double SpectrumReweighter::Weight(G4double energy) const {
+    if (energies.empty()) return 1.;
+    if (energy < energies.front() || energy > energies.back()) return 0.;
+    size_t i = std::upper_bound(energies.begin(), energies.end(), energy) - energies.begin();
+    if (i >= energies.size()) return weights.back();
+    G4double f = std::log(energy / energies[i - 1]) / std::log(energies[i] / energies[i - 1]);
+    return weights[i - 1] + f * (weights[i] - weights[i - 1]);
+}
+
+void SpectrumReweighter::Count(G4double weight) {
+    sum += weight;
+    sumSquares += weight * weight;
+    neutrons++;
+}
+
+void SpectrumReweighter::PrintReport() const {
+    if (!IsActive() || neutrons == 0) return;
+    G4double ess = EffectiveSampleSize();
+    G4cout << "\n=== Spectrum Reweighting ===" << G4endl;
+    G4cout << "Table: " << Sim::reweightFile << " (" << energies.front() << " - " << energies.back() << " MeV)" << G4endl;
+    G4cout << "Mean weight: " << sum / neutrons << G4endl;
+    G4cout << "Effective sample size: " << ess << " of " << neutrons << " neutrons" << G4endl;
+    if (ess < kMinEssFraction * neutrons) {
+        G4cout << "WARNING: Effective sample size below " << 100 * kMinEssFraction
+               << "% of the neutrons; the sampling spectrum covers the target poorly" << G4endl;
+    }
+    G4cout << "============================" << G4endl;
+}
@@ -0,0 +1,34 @@
+#ifndef SPECTRUM_REWEIGHTER_HH
+#define SPECTRUM_REWEIGHTER_HH
+
+#include "G4Types.hh"
+#include "G4String.hh"
+#include <vector>
+
+// Per-neutron weight target(E)/sampling(E) for the online accumulators, so a run simulated once
+// with a broad sampling spectrum fills frames and TOF cubes for another spectrum. The table is
+// written by lumacam.reweight.SpectrumReweighter.write_table; energies outside it get weight 0.
+// Tracks the effective sample size of the weights to flag over-aggressive reweighting.
+class SpectrumReweighter {
+public:
+    SpectrumReweighter();
+
+    void Reset(); // Load Sim::reweightFile (if set) and clear the statistics
+    G4bool IsActive() const { return !energies.empty(); }
+    G4double Weight(G4double energy) const; // energy in MeV
+    void Count(G4double weight); // Add one neutron's combined weight to the statistics
+    G4double EffectiveSampleSize() const { return sumSquares > 0 ? sum * sum / sumSquares : 0.; }
+    G4long Neutrons() const { return neutrons; }
+    void PrintReport() const;
+
+    static constexpr G4double kMinEssFraction = 0.1; // Warn below this ESS / neutrons
+
+private:
+    G4bool load(const G4String& fileName);
+
+    std::vector<G4double> energies, weights; // Ascending MeV, linear in log(energy) between points
+    G4double sum, sumSquares;
+    G4long neutrons;
+};
+
+#endif
@@ -0,0 +1,126 @@
+#include "TofCubeAccumulator.hh"
+#include "SimConfig.hh"
+#include "G4ios.hh"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+TofCubeAccumulator::TofCubeAccumulator()
+    : nx(0), ny(0), nt(0), fov(0.), logBins(true), active(false) {}
+
+void TofCubeAccumulator::Reset() {
+    tiles.clear();
+    tofEdges.clear();
+    active = false;
+    if (!Sim::tofCubeOutput) return;
+
+    nx = Sim::TOF_CUBE_NX;
+    ny = Sim::TOF_CUBE_NY;
+    nt = Sim::TOF_CUBE_BINS;
+    fov = (Sim::TOF_CUBE_FOV > 0 ? Sim::TOF_CUBE_FOV : Sim::SCINT_SIZE) / mm;
+    logBins = Sim::TOF_CUBE_LOG;
+    G4double tmin = Sim::TOF_CUBE_MIN / ns;
+    G4double tmax = Sim::TOF_CUBE_MAX / ns;
+    if (nx <= 0 || ny <= 0 || nt <= 0 || tmax <= tmin || (logBins && tmin <= 0)) {
+        G4cerr << "ERROR: Invalid TOF cube binning (log bins need tofMin > 0), TOF cube disabled" << G4endl;
+        return;
+    }
+
+    tofEdges.resize(nt + 1);
+    for (G4int i = 0; i <= nt; ++i) {
+        tofEdges[i] = logBins ? tmin * std::pow(tmax / tmin, static_cast<G4double>(i) / nt)
+                              : tmin + (tmax - tmin) * i / nt;
+    }
+    active = true;
+}
+
+G4int TofCubeAccumulator::tofBin(G4double tof) const {
+    if (tof < tofEdges.front() || tof >= tofEdges.back()) return -1;
+    G4double fraction = logBins ? std::log(tof / tofEdges.front()) / std::log(tofEdges.back() / tofEdges.front())
+                                : (tof - tofEdges.front()) / (tofEdges.back() - tofEdges.front());
+    return std::min(static_cast<G4int>(fraction * nt), nt - 1);
+}
+
+void TofCubeAccumulator::Fill(G4double x, G4double y, G4double tof, G4double weight) {
+    if (!active) return;
+
+    G4int it = tofBin(tof);
+    G4int ix = static_cast<G4int>(std::floor((x + fov/2) / fov * nx));
+    G4int iy = static_cast<G4int>(std::floor((y + fov/2) / fov * ny));
+    if (it < 0 || ix < 0 || ix >= nx || iy < 0 || iy >= ny) return;
+
+    uint64_t key = (static_cast<uint64_t>(ix / kTileXY) << 42) |
+                   (static_cast<uint64_t>(iy / kTileXY) << 21) |
+                   static_cast<uint64_t>(it / kTileT);
+    std::vector<float>& tile = tiles[key];
+    if (tile.empty()) tile.assign(kTileXY * kTileXY * kTileT, 0.f);
+    tile[((ix % kTileXY) * kTileXY + iy % kTileXY) * kTileT + it % kTileT] += weight;
+}
+
+// Little-endian file layout:
+//   char[8] "LCTOFCB1", int32 nx, ny, nt, tileXY, tileT, int32 logBins, float64 fov_mm,
+//   float64 tofEdges[nt + 1], uint64 nTiles, then per tile:
+//   int32 tx, ty, tt, uint8 encoding, uint32 n, and either n float32 (dense, encoding 0)
+//   or n x (uint16 offset, float32 value) (sparse, encoding 1).
+//   Offsets within a tile are ((x % tileXY) * tileXY + y % tileXY) * tileT + t % tileT.
+G4bool TofCubeAccumulator::Write(const std::filesystem::path& path) const {
+    if (!active) return false;
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out.is_open()) {
+        G4cerr << "ERROR: Failed to open TOF cube file: " << path << G4endl;
+        return false;
+    }
+
+    auto put = [&out](const auto& value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+
+    out.write("LCTOFCB1", 8);
+    put(static_cast<int32_t>(nx));
+    put(static_cast<int32_t>(ny));
+    put(static_cast<int32_t>(nt));
+    put(static_cast<int32_t>(kTileXY));
+    put(static_cast<int32_t>(kTileT));
+    put(static_cast<int32_t>(logBins));
+    put(fov);
+    out.write(reinterpret_cast<const char*>(tofEdges.data()), tofEdges.size() * sizeof(G4double));
+
+    // Sorted tile order keeps the file layout deterministic
+    std::vector<uint64_t> keys;
+    keys.reserve(tiles.size());
+    for (const auto& entry : tiles) keys.push_back(entry.first);
+    std::sort(keys.begin(), keys.end());
+    put(static_cast<uint64_t>(keys.size()));
+
+    const uint32_t tileSize = kTileXY * kTileXY * kTileT;
+    size_t denseTiles = 0;
+    for (uint64_t key : keys) {
+        const std::vector<float>& tile = tiles.at(key);
+        put(static_cast<int32_t>(key >> 42));
+        put(static_cast<int32_t>((key >> 21) & 0x1FFFFF));
+        put(static_cast<int32_t>(key & 0x1FFFFF));
+
+        uint32_t nonZero = std::count_if(tile.begin(), tile.end(), [](float v) { return v != 0.f; });
+        // Sparse entries cost 6 bytes against 4 for dense ones
+        if (nonZero * 6 < tileSize * 4) {
+            put(static_cast<uint8_t>(1));
+            put(nonZero);
+            for (uint32_t i = 0; i < tileSize; ++i) {
+                if (tile[i] == 0.f) continue;
+                put(static_cast<uint16_t>(i));
+                put(tile[i]);
+            }
+        } else {
+            put(static_cast<uint8_t>(0));
+            put(tileSize);
+            out.write(reinterpret_cast<const char*>(tile.data()), tileSize * sizeof(float));
+            denseTiles++;
+        }
+    }
+
+    G4cout << "TofCubeAccumulator: " << nx << "x" << ny << "x" << nt << " cube with "
+           << keys.size() << " tiles (" << denseTiles << " dense) written to " << path << G4endl;
+    return out.good();
+}
@@ -0,0 +1,36 @@
+#ifndef TOF_CUBE_ACCUMULATOR_HH
+#define TOF_CUBE_ACCUMULATOR_HH
+
+#include "G4Types.hh"
+#include <cstdint>
+#include <filesystem>
+#include <unordered_map>
+#include <vector>
+
+// Online (x, y, TOF) image stack for energy-resolved imaging. TOF is toa - pulse time,
+// binned linearly or logarithmically. Counts live in fixed-size tiles that are only
+// allocated once hit, so mostly-empty cubes with thousands of TOF bins stay small.
+class TofCubeAccumulator {
+public:
+    TofCubeAccumulator();
+
+    void Reset(); // Configure from Sim:: settings and clear all tiles
+    G4bool IsActive() const { return active; }
+    void Fill(G4double x, G4double y, G4double tof, G4double weight);
+    G4bool Write(const std::filesystem::path& path) const;
+    size_t GetAllocatedTiles() const { return tiles.size(); }
+
+    static constexpr G4int kTileXY = 16; // Pixels per tile side
+    static constexpr G4int kTileT = 64; // TOF bins per tile
+
+private:
+    G4int tofBin(G4double tof) const;
+
+    std::unordered_map<uint64_t, std::vector<float>> tiles; // Tile key -> kTileXY*kTileXY*kTileT counts
+    std::vector<G4double> tofEdges; // nt + 1 edges in ns
+    G4int nx, ny, nt;
+    G4double fov; // mm
+    G4bool logBins, active;
+};
+
+#endif
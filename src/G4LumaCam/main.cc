@@ -3,25 +3,70 @@
 #include "ParticleGenerator.hh"
 #include "SimulationManager.hh"
 #include "EventProcessor.hh"
+#include "FastBoundaryProcess.hh"
 #include "G4RunManager.hh"
 #include "G4UImanager.hh"
+#ifndef LUMACAM_BATCH
 #include "G4UIExecutive.hh"
 #include "G4VisExecutive.hh"
+#endif
 #include "QGSP_BERT_HP.hh"
 #include "G4OpticalPhysics.hh"
 #include "G4RadioactiveDecayPhysics.hh"
+#include "G4FastSimulationPhysics.hh"
+#include <chrono>
+#include <vector>
+#include <sys/resource.h>
+
+// Print wall time since launch and peak RSS, to compare interactive and batch startup cost
+static void reportStartup(const std::chrono::steady_clock::time_point& start) {
+    G4double seconds = std::chrono::duration<G4double>(std::chrono::steady_clock::now() - start).count();
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    G4cout << "Startup: " << seconds << " s, peak RSS " << usage.ru_maxrss / 1024. << " MB" << G4endl;
+}
 
 int main(int argc, char** argv) {
+    auto startTime = std::chrono::steady_clock::now();
+
+    // Options that select physics must be known before construction, ahead of any macro
+    std::vector<char*> args{argv[0]};
+    for (int i = 1; i < argc; ++i) {
+        if (G4String(argv[i]) == "--neutron-plane") Sim::neutronPlane = true;
+        else args.push_back(argv[i]);
+    }
+    argc = static_cast<int>(args.size());
+    argv = args.data();
+
+#ifdef LUMACAM_BATCH
+    if (argc < 2) {
+        G4cerr << "Usage: " << argv[0] << " [--neutron-plane] macro.mac" << G4endl;
+        return 1;
+    }
+#endif
+
     Sim::batchSize = 10000; // Default, will be overridden by macro if set
     
     G4RunManager* runMgr = new G4RunManager();
     
     G4VModularPhysicsList* phys = new QGSP_BERT_HP();
-    G4OpticalPhysics* optPhys = new G4OpticalPhysics();
-    optPhys->Configure(kCerenkov, true);
-    optPhys->Configure(kScintillation, true);
-    phys->RegisterPhysics(optPhys);
+    if (!Sim::neutronPlane) {
+        G4OpticalPhysics* optPhys = new G4OpticalPhysics();
+        optPhys->Configure(kCerenkov, true);
+        optPhys->Configure(kScintillation, true);
+        phys->RegisterPhysics(optPhys);
+        // OpBoundary with the shortcut for trivial surfaces (/lumacam/opticalFastPath)
+        phys->RegisterPhysics(new FastBoundaryPhysics());
+    } else {
+        G4cout << "Neutron-plane mode: optical physics disabled, recording neutrons entering the scintillator" << G4endl;
+    }
     phys->RegisterPhysics(new G4RadioactiveDecayPhysics());
+    // Fast simulation hook for the scintillator models (/lumacam/fastScintModels, rangeTableLight)
+    G4FastSimulationPhysics* fastSimPhys = new G4FastSimulationPhysics();
+    for (const char* particle : {"neutron", "proton", "triton", "alpha"}) {
+        fastSimPhys->ActivateFastSimulation(particle);
+    }
+    phys->RegisterPhysics(fastSimPhys);
     runMgr->SetUserInitialization(phys);
     
     ParticleGenerator* gen = new ParticleGenerator();
@@ -32,11 +77,15 @@ int main(int argc, char** argv) {
     SimulationManager* simMgr = new SimulationManager();
     runMgr->SetUserAction(simMgr);
     runMgr->SetUserAction(new SimulationManager::EventHandler(simMgr));
+    runMgr->SetUserAction(new SimulationManager::SteppingHandler(simMgr));
     
     runMgr->Initialize();
     
+#ifndef LUMACAM_BATCH
     G4VisManager* visMgr = new G4VisExecutive();
     visMgr->Initialize();
+#endif
+    reportStartup(startTime);
     
     G4UImanager* uiMgr = G4UImanager::GetUIpointer();
     
@@ -52,7 +101,9 @@ int main(int argc, char** argv) {
         G4cout << "Total neutrons set to: " << eventsToProcess 
                << " (from /run/beamOn in macro)" << G4endl;
         G4cout << "Batch size set to: " << Sim::batchSize << G4endl;
-    } else {
+    }
+#ifndef LUMACAM_BATCH
+    else {
         // Interactive mode
         G4int defaultNeutrons = 10000;
         simMgr->SetTotalNeutrons(defaultNeutrons);
@@ -107,6 +158,7 @@ int main(int argc, char** argv) {
         delete visMgr;
         visMgr = nullptr;
     }
+#endif
     if (runMgr) {
         delete runMgr;
         runMgr = nullptr;
@@ -1,4 +1,8 @@
 # from lumacam import analysis, optics, simulate
 from lumacam.analysis import Analysis
 from lumacam.optics import Lens, DetectorModel, VerbosityLevel
-from lumacam.simulate import Simulate, Config
\ No newline at end of file
+from lumacam.simulate import Simulate, Config
+from lumacam.replay import Replay
+from lumacam.reader import PhotonReader
+from lumacam.reweight import SpectrumReweighter
+from lumacam.retime import Retimer
\ No newline at end of file
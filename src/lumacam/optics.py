@@ -27,6 +27,7 @@ import os
 import struct
 import json
 import shutil
+from lumacam.tpx3 import TICK_NS, encode_pixels, encode_tdc
 
 class VerbosityLevel(IntEnum):
     """Verbosity levels for simulation output."""
@@ -1613,9 +1614,7 @@ class Lens:
         """
         Convert traced photon data to valid TPX3 binary files, following the SERVAL TPX3 raw file format.
         """
-        # Constants
-        TICK_NS = 1.5625  # ToA tick size (1.5625 ns)
-        TOT_TICK_NS = 25.0  # ToT tick size (25 ns per TPX3 spec)
+        # Constants (packet ticks in lumacam.tpx3)
         MAX_TDC_TIMESTAMP_S = (2**32) * 25e-9  # ~107.37 seconds
         MAX_CHUNK_BYTES = 65535
         TIMER_TICK_NS = 409.6  # GTS timer tick
@@ -1629,56 +1628,6 @@ class Lens:
             msb_word = (0x4 << 60) | (0x5 << 56) | ((timer_value >> 32) & 0xFFFF) << 16
             return struct.pack("<Q", lsb_word) + struct.pack("<Q", msb_word)
         
-        def encode_tdc_packet(trigger_time_ns, trigger_counter, tdc_channel=1, edge_type='rising'):
-            """
-            Encode TDC trigger packet following TPX3 format.
-            
-            From C++ decoder:
-            coarsetime = (temp >> 12) & 0xFFFFFFFF  (32 bits in 25ns units)
-            tmpfine = (temp >> 5) & 0xF  (4 bits, clock phase 1-12)
-            trigtime_fine = (temp & 0x0E00) | (((tmpfine-1) << 9) / 12)
-            tdc_time = coarsetime*25e-9 + trigtime_fine*(25/4096)*1e-9
-            """
-            # Determine header
-            if tdc_channel == 1:
-                header = 0x6F if edge_type == 'rising' else 0x6A
-            else:
-                header = 0x6E if edge_type == 'rising' else 0x6B
-            
-            # Coarse time: 25ns resolution (32 bits)
-            coarsetime = int(trigger_time_ns / 25.0) & 0xFFFFFFFF
-            
-            # Fine time: sub-25ns component
-            fine_ns = trigger_time_ns - (coarsetime * 25.0)
-            
-            # Convert to 12-bit trigtime_fine (0-4095 representing 0-25ns)
-            trigtime_fine = int(round(fine_ns * 4096.0 / 25.0)) & 0xFFF
-            
-            # Extract upper 3 bits (bits 9-11)
-            fine_upper = (trigtime_fine >> 9) & 0x7
-            
-            # Extract lower 9 bits
-            fine_lower = trigtime_fine & 0x1FF
-            
-            # Reverse tmpfine encoding: fine_lower ≈ ((tmpfine-1) << 9) / 12
-            # So: tmpfine ≈ (fine_lower * 12 / 512) + 1
-            if fine_lower == 0:
-                tmpfine = 1
-            else:
-                tmpfine = int(round((fine_lower * 12.0 / 512.0) + 1.0))
-                tmpfine = max(1, min(12, tmpfine))
-            
-            # Build 64-bit TDC packet
-            tdc_word = (
-                (int(header) << 56) |
-                ((trigger_counter & 0xFFF) << 44) |
-                ((coarsetime & 0xFFFFFFFF) << 12) |
-                ((fine_upper & 0x7) << 9) |
-                ((tmpfine & 0xF) << 5)
-            )
-            
-            return struct.pack("<Q", tdc_word)
-        
         if traced_data is None or len(traced_data) == 0:
             if verbosity >= 2:
                 print("No traced photon data provided")
@@ -1764,15 +1713,6 @@ class Lens:
         # Convert ToA to 1.5625ns ticks
         toa_ticks = np.round(toa_ns / TICK_NS).astype(np.int64)
         
-        # Decompose ToA into packet fields
-        spidr_time = ((toa_ticks >> 18) & 0xFFFF).astype(np.int64)  # 16 bits
-        coarse_toa = ((toa_ticks >> 4) & 0x3FFF).astype(np.int64)
-        ftoa = (15 - (toa_ticks & 0xF)).astype(np.int64)
-        ftoa = np.clip(ftoa, 0, 15)
-        
-        # Convert ToT to ticks (10-bit, 25ns resolution per TPX3 spec)
-        tot_ticks = np.clip(np.round(tot_ns / TOT_TICK_NS).astype(np.int64), 1, 0x3FF)
-        
         # Encode PixAddr using TPX3 hierarchical addressing scheme
         # C++ decoder extracts from 64-bit word at these positions:
         #   dcol = (word >> 52) & 0x7F    (bits 58-52, 7 bits)
@@ -1806,26 +1746,7 @@ class Lens:
                 print(f"    ({px[i]},{py[i]}) → dcol={dcol[i]}, spix={spix[i]}, pix={pix[i]} → ({decoded_x},{decoded_y}) {match}")
         
         # Encode pixel packets
-        pixel_packets = []
-        for j in range(len(df)):
-            # Build 64-bit pixel packet
-            # Based on reverse engineering from actual decoder output:
-            # The PixAddr field needs special encoding
-            # Treating it as a 16-bit field at bits 59-44
-            
-            # Standard TPX3: PixAddr encodes doublecolumn, superpixel, pixel
-            # dcol (7 bits) | spix (6 bits) | pix (3 bits) = 16 bits
-            pix_addr_16bit = ((int(dcol[j]) & 0x7F) << 9) | ((int(spix[j]) & 0x3F) << 3) | (int(pix[j]) & 0x7)
-            
-            pixel_word = (
-                (0xB << 60) |
-                ((pix_addr_16bit & 0xFFFF) << 44) |
-                ((int(coarse_toa[j]) & 0x3FFF) << 30) |
-                ((int(tot_ticks[j]) & 0x3FF) << 20) |
-                ((int(ftoa[j]) & 0xF) << 16) |
-                (int(spidr_time[j]) & 0xFFFF)
-            )
-            pixel_packets.append(struct.pack("<Q", pixel_word))
+        pixel_packets = encode_pixels(px, py, toa_ns, tot_ns)
         
         # Determine file groups
         file_groups = []
@@ -1952,8 +1873,7 @@ class Lens:
                 pulse_id = group.get('pulse_id')
                 
                 if trigger_ns is not None and pulse_id is not None:
-                    tdc_packet = encode_tdc_packet(trigger_ns, pulse_id, 1, 'rising')
-                    content += tdc_packet
+                    content += encode_tdc([trigger_ns], [pulse_id]).astype("<u8").tobytes()
                     n_triggers = 1
                     
                     if verbosity >= 2:
@@ -1965,16 +1885,14 @@ class Lens:
                 
                 for pulse_id, trigger_ns in sorted(triggers.items()):
                     if trigger_ns is not None:
-                        tdc_packet = encode_tdc_packet(trigger_ns, pulse_id, 1, 'rising')
-                        content += tdc_packet
+                        content += encode_tdc([trigger_ns], [pulse_id]).astype("<u8").tobytes()
                         n_triggers += 1
                 
                 if verbosity >= 2 and n_triggers > 0:
                     print(f"  File {file_idx + 1}: {n_triggers} TDC trigger(s)")
             
             # Add pixel packets
-            for j in range(start_idx, end_idx):
-                content += pixel_packets[j]
+            content += pixel_packets[start_idx:end_idx].astype("<u8").tobytes()
             
             # Determine filename
             neutron_id = group.get('neutron_id')
@@ -0,0 +1,393 @@
+import ctypes
+import os
+import struct
+from importlib import resources
+from pathlib import Path
+from typing import Iterator, List, Optional, Sequence, Tuple, Union
+
+import numpy as np
+import pandas as pd
+
+# Photon columns in file order, as written to SimPhotons CSV and .lcph files
+COLUMNS = ["id", "parent_id", "neutron_id", "pulse_id", "pulse_time_ns", "x", "y", "z", "dx", "dy", "dz",
+           "toa", "wavelength", "parentName", "px", "py", "pz", "parentEnergy", "nx", "ny", "nz",
+           "neutronEnergy", "weight"]
+
+# Predicate keyword -> column; ranges are inclusive (min, max), None for an open end
+PREDICATES = {"neutron_id": "neutron_id", "pulse_id": "pulse_id", "toa": "toa", "neutron_energy": "neutronEnergy",
+              "x": "x", "y": "y"}
+
+# Binary layout constants, see PhotonFormat.hh
+MAGIC = b"LCPHOT03"
+INDEX_MAGIC = b"LCPHIDX1"
+HEADER_SIZE = 25
+BLOCK_HEADER = struct.Struct("<IIIiiiiqqffiiii")
+INDEX_ENTRY = struct.Struct("<Q" + BLOCK_HEADER.format[1:])
+TRAILER = struct.Struct("<QQ8s")
+
+_library = None
+
+
+class _Query(ctypes.Structure):
+    _fields_ = [("neutron_id", ctypes.c_int64 * 2), ("pulse_id", ctypes.c_int64 * 2),
+                ("toa", ctypes.c_double * 2), ("neutron_energy", ctypes.c_double * 2),
+                ("x", ctypes.c_double * 2), ("y", ctypes.c_double * 2)]
+
+
+def _load_library() -> Optional[ctypes.CDLL]:
+    """Load liblumacam_reader from LUMACAM_READER_LIB or the G4LumaCam bin directory, or None."""
+    global _library
+    if _library is not None:
+        return _library or None
+    candidates = [os.environ.get("LUMACAM_READER_LIB")]
+    try:
+        with resources.path('G4LumaCam', 'bin') as bin_path:
+            candidates += [os.path.join(bin_path, name)
+                           for name in ("liblumacam_reader.so", "liblumacam_reader.dylib")]
+    except (ModuleNotFoundError, FileNotFoundError):
+        pass
+    for candidate in candidates:
+        if candidate and os.path.exists(candidate):
+            lib = ctypes.CDLL(candidate)
+            lib.lcph_open.restype = ctypes.c_void_p
+            lib.lcph_open.argtypes = [ctypes.c_char_p, ctypes.c_char_p, ctypes.c_size_t]
+            lib.lcph_close.argtypes = [ctypes.c_void_p]
+            lib.lcph_weighted.argtypes = [ctypes.c_void_p]
+            lib.lcph_num_blocks.restype = ctypes.c_size_t
+            lib.lcph_num_blocks.argtypes = [ctypes.c_void_p]
+            lib.lcph_plan.restype = ctypes.c_size_t
+            lib.lcph_plan.argtypes = [ctypes.c_void_p, ctypes.POINTER(_Query), ctypes.c_size_t,
+                                      ctypes.c_size_t, ctypes.POINTER(ctypes.c_size_t)]
+            lib.lcph_read.restype = ctypes.c_int64
+            lib.lcph_read.argtypes = [ctypes.c_void_p, ctypes.POINTER(_Query), ctypes.c_size_t, ctypes.c_size_t,
+                                      ctypes.POINTER(ctypes.c_int), ctypes.c_size_t,
+                                      ctypes.POINTER(ctypes.c_void_p), ctypes.c_size_t, ctypes.c_int,
+                                      ctypes.c_char_p, ctypes.c_size_t]
+            lib.lcph_num_types.restype = ctypes.c_size_t
+            lib.lcph_num_types.argtypes = [ctypes.c_void_p]
+            lib.lcph_type_name.restype = ctypes.c_char_p
+            lib.lcph_type_name.argtypes = [ctypes.c_void_p, ctypes.c_size_t]
+            lib.lcph_column_is_int.argtypes = [ctypes.c_int]
+            _library = lib
+            return lib
+    _library = False
+    return None
+
+
+def _decode_block(data: bytes, pos: int, end: int, grid: float, tick: float, weighted: bool) -> list:
+    """Decode the event records in data[pos:end] into rows in COLUMNS order (without weight if
+    the file is unweighted). Decoder state starts fresh, as at the start of every block."""
+
+    def varint():
+        nonlocal pos
+        value = shift = 0
+        while True:
+            byte = data[pos]
+            pos += 1
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if byte < 0x80:
+                return value
+
+    def svarint():
+        value = varint()
+        return (value >> 1) ^ -(value & 1)
+
+    def direction(u, v):
+        if u == v == -32768:
+            return 0.0, 0.0, 0.0
+        a, b = u / 32767.0, v / 32767.0
+        z = 1.0 - abs(a) - abs(b)
+        if z < 0:
+            a, b = (1.0 - abs(b)) * (1.0 if a >= 0 else -1.0), (1.0 - abs(a)) * (1.0 if b >= 0 else -1.0)
+        norm = (a * a + b * b + z * z) ** 0.5
+        return a / norm, b / norm, z / norm
+
+    neutron = struct.Struct("<iiif")
+    parent = struct.Struct("<iiif")
+    photon = struct.Struct("<hhH")
+    types: List[str] = []
+    rows = []
+    neutron_id = -1
+    while pos < end:
+        neutron_id += svarint()
+        pulse_id = svarint()
+        pulse_ticks = svarint()
+        nx, ny, nz, neutron_energy = neutron.unpack_from(data, pos)
+        pos += neutron.size
+
+        parents = []
+        parent_id = 0
+        for _ in range(varint()):
+            parent_id += svarint()
+            type_index = varint()
+            if type_index == len(types):
+                length = varint()
+                types.append(data[pos:pos + length].decode())
+                pos += length
+            px, py, pz, parent_energy = parent.unpack_from(data, pos)
+            pos += parent.size
+            parents.append((parent_id, types[type_index], px * grid, py * grid, pz * grid, parent_energy, (px, py, pz)))
+
+        photon_id = 0
+        toa = pulse_ticks
+        for _ in range(varint()):
+            photon_id += varint()
+            parent_id, parent_type, px, py, pz, parent_energy, parent_grid = parents[varint()]
+            x, y, z = (origin + svarint() for origin in parent_grid)
+            u, v, wavelength = photon.unpack_from(data, pos)
+            pos += photon.size
+            toa += svarint()
+            row = [photon_id, parent_id, neutron_id, pulse_id, pulse_ticks * tick,
+                   x * grid, y * grid, z * grid, *direction(u, v), toa * tick, wavelength * 0.01,
+                   parent_type, px, py, pz, parent_energy, nx * grid, ny * grid, nz * grid, neutron_energy]
+            if weighted:
+                row.append(struct.unpack_from("<f", data, pos)[0])
+                pos += 4
+            rows.append(row)
+    return rows
+
+
+def read_block_index(path: Union[str, Path]) -> pd.DataFrame:
+    """Per-block statistics of a binary photon file, from its footer index or, for an
+    interrupted run, by walking the block headers.
+
+    Returns:
+        pd.DataFrame: offset, bytes, events, photons, neutron_id_min/max, pulse_id_min/max,
+        toa_min/max (ns), neutron_energy_min/max and x_min/max, y_min/max (mm) per block.
+        Empty for files that are not LCPHOT03.
+    """
+    columns = ["offset", "bytes", "events", "photons", "neutron_id_min", "neutron_id_max",
+               "pulse_id_min", "pulse_id_max", "toa_min", "toa_max", "neutron_energy_min", "neutron_energy_max",
+               "x_min", "x_max", "y_min", "y_max"]
+    with open(path, "rb") as f:
+        header = f.read(HEADER_SIZE)
+        if header[:8] != MAGIC:
+            return pd.DataFrame(columns=columns)
+        grid, tick = struct.unpack_from("<dd", header, 8)
+        size = f.seek(0, os.SEEK_END)
+        entries = []
+        if size >= HEADER_SIZE + TRAILER.size:
+            f.seek(size - TRAILER.size)
+            n_blocks, index_offset, magic = TRAILER.unpack(f.read(TRAILER.size))
+            if magic == INDEX_MAGIC and index_offset + n_blocks * INDEX_ENTRY.size + TRAILER.size == size:
+                f.seek(index_offset)
+                entries = list(INDEX_ENTRY.iter_unpack(f.read(n_blocks * INDEX_ENTRY.size)))
+        if not entries:
+            offset = HEADER_SIZE
+            while offset + BLOCK_HEADER.size <= size:
+                f.seek(offset)
+                stats = BLOCK_HEADER.unpack(f.read(BLOCK_HEADER.size))
+                if offset + BLOCK_HEADER.size + stats[0] > size:
+                    break
+                entries.append((offset, *stats))
+                offset += BLOCK_HEADER.size + stats[0]
+    index = pd.DataFrame(entries, columns=columns)
+    index[["toa_min", "toa_max"]] = index[["toa_min", "toa_max"]].astype(float) * tick
+    bounds = ["x_min", "x_max", "y_min", "y_max"]
+    index[bounds] = index[bounds].astype(float) * grid
+    return index
+
+
+class PhotonReader:
+    """Read SimPhotons output (.lcph and CSV) loading only the columns and rows asked for.
+
+    Binary files are filtered per block on their neutron_id, pulse_id, toa, neutronEnergy and
+    x/y ranges before anything is decoded, and the remaining blocks are decoded in parallel by
+    liblumacam_reader when it is installed (pure Python otherwise). CSV files are read with
+    pandas column selection and filtered row-wise.
+
+    The x/y ranges select a rectangular region of interest on the stored photon x, y columns.
+    Files written with Config.codec_tile_size have one tile per block, so such a query decodes
+    only the tiles that overlap the region; untiled blocks usually span the whole scintillator.
+
+    Example:
+        reader = PhotonReader("archive/test/SimPhotons", columns=["x", "y", "toa"], pulse_id=(10, 19))
+        for chunk in reader.iter_chunks(1_000_000):
+            ...
+        roi = PhotonReader("archive/test/SimPhotons", x=(-5, 5), y=(0, 10)).read()
+    """
+
+    def __init__(self, source: Union[str, Path, Sequence[Union[str, Path]]],
+                 columns: Optional[Sequence[str]] = None,
+                 neutron_id: Optional[Tuple[Optional[int], Optional[int]]] = None,
+                 pulse_id: Optional[Tuple[Optional[int], Optional[int]]] = None,
+                 toa: Optional[Tuple[Optional[float], Optional[float]]] = None,
+                 neutron_energy: Optional[Tuple[Optional[float], Optional[float]]] = None,
+                 x: Optional[Tuple[Optional[float], Optional[float]]] = None,
+                 y: Optional[Tuple[Optional[float], Optional[float]]] = None,
+                 threads: int = 0, native: bool = True):
+        """
+        Args:
+            source: A photon file, a SimPhotons directory (all *.csv and *.lcph files), or a list of files.
+            columns: Columns to load (default all); unknown columns are ignored.
+            neutron_id, pulse_id, toa, neutron_energy, x, y: Inclusive (min, max) ranges; toa in ns,
+                neutron_energy in MeV, x and y in mm. None on either side leaves it open.
+            threads: Decoder threads for binary files, 0 for one per core.
+            native: Use liblumacam_reader when available.
+        """
+        if isinstance(source, (str, Path)):
+            source = Path(source)
+            self.files = sorted(list(source.glob("*.csv")) + list(source.glob("*.lcph"))) if source.is_dir() else [source]
+        else:
+            self.files = [Path(f) for f in source]
+        self.columns = list(columns) if columns is not None else None
+        self.ranges = {}
+        for key, value in (("neutron_id", neutron_id), ("pulse_id", pulse_id), ("toa", toa),
+                           ("neutron_energy", neutron_energy), ("x", x), ("y", y)):
+            if value is not None:
+                self.ranges[PREDICATES[key]] = value
+        self.threads = threads
+        self.library = _load_library() if native else None
+
+    def read(self) -> pd.DataFrame:
+        """Load all matching rows.
+
+        Returns:
+            pd.DataFrame: The selected columns, in file order.
+        """
+        dfs = [chunk for chunk in self._iter_files(None) if len(chunk) > 0]
+        if not dfs:
+            return pd.DataFrame(columns=self._wanted(COLUMNS))
+        return pd.concat(dfs, ignore_index=True)
+
+    def iter_chunks(self, chunk_rows: int = 1_000_000) -> Iterator[pd.DataFrame]:
+        """Yield matching rows in chunks of about chunk_rows (binary chunks are whole blocks,
+        so a chunk can exceed chunk_rows by up to one block). Chunks never span files.
+        """
+        for chunk in self._iter_files(chunk_rows):
+            if len(chunk) > 0:
+                yield chunk
+
+    def _wanted(self, available: Sequence[str]) -> List[str]:
+        if self.columns is None:
+            return list(available)
+        return [c for c in self.columns if c in available]
+
+    def _filter(self, df: pd.DataFrame) -> pd.DataFrame:
+        mask = np.ones(len(df), dtype=bool)
+        for column, (low, high) in self.ranges.items():
+            if column not in df.columns:
+                continue
+            if low is not None:
+                mask &= (df[column] >= low).to_numpy()
+            if high is not None:
+                mask &= (df[column] <= high).to_numpy()
+        return df if mask.all() else df[mask].reset_index(drop=True)
+
+    def _iter_files(self, chunk_rows: Optional[int]) -> Iterator[pd.DataFrame]:
+        for path in self.files:
+            if path.suffix == ".lcph":
+                with open(path, "rb") as f:
+                    magic = f.read(8)
+                if magic == MAGIC and self.library is not None:
+                    yield from self._read_native(path, chunk_rows)
+                else:
+                    yield from self._read_python(path, chunk_rows)
+            else:
+                yield from self._read_csv(path, chunk_rows)
+
+    def _read_csv(self, path: Path, chunk_rows: Optional[int]) -> Iterator[pd.DataFrame]:
+        if path.stat().st_size == 0:
+            return
+        wanted = set(self._wanted(COLUMNS)) | set(self.ranges)
+        usecols = None if self.columns is None else (lambda c: c in wanted)
+        try:
+            if chunk_rows is None:
+                chunks = [pd.read_csv(path, usecols=usecols)]
+            else:
+                chunks = pd.read_csv(path, usecols=usecols, chunksize=chunk_rows)
+            for df in chunks:
+                df = self._filter(df)
+                yield df[self._wanted(df.columns)] if self.columns is not None else df
+        except pd.errors.EmptyDataError:
+            return
+
+    def _query(self) -> _Query:
+        query = _Query()
+        limits = {"neutron_id": (-2**63, 2**63 - 1), "pulse_id": (-2**63, 2**63 - 1),
+                  "toa": (-np.inf, np.inf), "neutronEnergy": (-np.inf, np.inf),
+                  "x": (-np.inf, np.inf), "y": (-np.inf, np.inf)}
+        for column, field in (("neutron_id", "neutron_id"), ("pulse_id", "pulse_id"), ("toa", "toa"),
+                              ("neutronEnergy", "neutron_energy"), ("x", "x"), ("y", "y")):
+            low, high = self.ranges.get(column, (None, None))
+            default_low, default_high = limits[column]
+            target = getattr(query, field)
+            target[0] = default_low if low is None else low
+            target[1] = default_high if high is None else high
+        return query
+
+    def _read_native(self, path: Path, chunk_rows: Optional[int]) -> Iterator[pd.DataFrame]:
+        lib = self.library
+        error = ctypes.create_string_buffer(512)
+        handle = lib.lcph_open(str(path).encode(), error, len(error))
+        if not handle:
+            raise ValueError(error.value.decode())
+        try:
+            weighted = bool(lib.lcph_weighted(handle))
+            names = self._wanted([c for c in COLUMNS if weighted or c != "weight"])
+            indices = (ctypes.c_int * len(names))(*[COLUMNS.index(c) for c in names])
+            query = self._query()
+            n_blocks = lib.lcph_num_blocks(handle)
+            max_rows = chunk_rows if chunk_rows is not None else 2**63 - 1
+            first = 0
+            while first < n_blocks:
+                last = ctypes.c_size_t()
+                capacity = lib.lcph_plan(handle, ctypes.byref(query), first, max_rows, ctypes.byref(last))
+                if capacity > 0:
+                    arrays = [np.empty(capacity, dtype=np.int32 if lib.lcph_column_is_int(i) else np.float64)
+                              for i in indices]
+                    outputs = (ctypes.c_void_p * len(arrays))(*[a.ctypes.data for a in arrays])
+                    rows = lib.lcph_read(handle, ctypes.byref(query), first, last.value, indices, len(names),
+                                         outputs, capacity, self.threads, error, len(error))
+                    if rows < 0:
+                        raise ValueError(f"{path}: {error.value.decode()}")
+                    data = {name: array[:rows] for name, array in zip(names, arrays)}
+                    if "parentName" in data:
+                        types = np.array([lib.lcph_type_name(handle, t).decode()
+                                          for t in range(lib.lcph_num_types(handle))], dtype=object)
+                        data["parentName"] = types[data["parentName"]]
+                    yield pd.DataFrame(data)
+                first = last.value
+        finally:
+            lib.lcph_close(handle)
+
+    def _read_python(self, path: Path, chunk_rows: Optional[int]) -> Iterator[pd.DataFrame]:
+        with open(path, "rb") as f:
+            header = f.read(HEADER_SIZE)
+            if len(header) < HEADER_SIZE or header[:8] != MAGIC:
+                raise ValueError(f"{path} is not a lumacam binary photon file")
+            grid, tick = struct.unpack_from("<dd", header, 8)
+            weighted = bool(header[24])
+            columns = COLUMNS if weighted else COLUMNS[:-1]
+
+            index = read_block_index(path)
+            keep = np.ones(len(index), dtype=bool)
+            for column, low_key, high_key in (("neutron_id", "neutron_id_min", "neutron_id_max"),
+                                              ("pulse_id", "pulse_id_min", "pulse_id_max"),
+                                              ("toa", "toa_min", "toa_max"),
+                                              ("neutronEnergy", "neutron_energy_min", "neutron_energy_max"),
+                                              ("x", "x_min", "x_max"), ("y", "y_min", "y_max")):
+                low, high = self.ranges.get(column, (None, None))
+                if low is not None:
+                    keep &= (index[high_key] >= low).to_numpy()
+                if high is not None:
+                    keep &= (index[low_key] <= high).to_numpy()
+            keep &= (index["photons"] > 0).to_numpy()
+            spans = [(int(o) + BLOCK_HEADER.size, int(o) + BLOCK_HEADER.size + int(b))
+                     for o, b in zip(index["offset"][keep], index["bytes"][keep])]
+
+            # Only the selected blocks are read
+            pending, pending_rows = [], 0
+            for start, end in spans:
+                f.seek(start)
+                block = f.read(end - start)
+                df = self._filter(pd.DataFrame(_decode_block(block, 0, len(block), grid, tick, weighted),
+                                               columns=columns))
+                pending.append(df[self._wanted(columns)])
+                pending_rows += len(df)
+                if chunk_rows is not None and pending_rows >= chunk_rows:
+                    yield pd.concat(pending, ignore_index=True)
+                    pending, pending_rows = [], 0
+            if pending:
+                yield pd.concat(pending, ignore_index=True)
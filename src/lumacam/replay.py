@@ -0,0 +1,234 @@
+import argparse
+import socket
+import time
+from dataclasses import dataclass
+from pathlib import Path
+from typing import BinaryIO, Tuple, Union
+
+import numpy as np
+import pandas as pd
+
+from lumacam.reader import PhotonReader
+from lumacam.tpx3 import encode_pixels, encode_tdc
+
+# Fixed little-endian records for format="records"; time_ns is the global time of arrival
+RECORD_DTYPES = {
+    "photons": np.dtype([("time_ns", "<f8"), ("x", "<f4"), ("y", "<f4"), ("wavelength", "<f4"),
+                         ("neutron_id", "<i4"), ("pulse_id", "<i4")]),
+    "hits": np.dtype([("time_ns", "<f8"), ("pixel_x", "<u2"), ("pixel_y", "<u2"), ("tot_ns", "<f4"),
+                      ("neutron_id", "<i4"), ("pulse_id", "<i4")]),
+}
+
+@dataclass
+class ReplayReport:
+    """Throughput and back-pressure of one replay."""
+    records: int = 0
+    bytes: int = 0
+    simulated_s: float = 0.0  # Span of the replayed timestamps
+    wall_s: float = 0.0
+    blocked_s: float = 0.0  # Time spent inside writes, i.e. waiting on the consumer
+    max_lag_s: float = 0.0  # Largest delay of a chunk behind its scheduled send time
+    late_chunks: int = 0  # Chunks sent after their scheduled time
+
+    @property
+    def records_per_s(self) -> float:
+        return self.records / self.wall_s if self.wall_s > 0 else 0.0
+
+    @property
+    def mb_per_s(self) -> float:
+        return self.bytes / self.wall_s / 1e6 if self.wall_s > 0 else 0.0
+
+    @property
+    def speedup(self) -> float:
+        """Achieved simulated time per wall time; below rate_factor when the consumer throttles."""
+        return self.simulated_s / self.wall_s if self.wall_s > 0 else 0.0
+
+    def __str__(self) -> str:
+        blocked = 100.0 * self.blocked_s / self.wall_s if self.wall_s > 0 else 0.0
+        return (f"Replay: {self.records} records, {self.bytes / 1e6:.2f} MB in {self.wall_s:.3f} s\n"
+                f"  Throughput: {self.records_per_s:.0f} records/s, {self.mb_per_s:.2f} MB/s\n"
+                f"  Simulated span: {self.simulated_s:.6f} s (speedup {self.speedup:.2f}x)\n"
+                f"  Back-pressure: {self.blocked_s:.3f} s blocked in writes ({blocked:.1f}%), "
+                f"{self.late_chunks} late chunks, max lag {self.max_lag_s * 1e3:.2f} ms")
+
+
+class Replay:
+    """Stream a finished lumacam output set in simulated time order, e.g. to load-test DAQ
+    and reconstruction software at realistic or accelerated rates.
+
+    Sources are "photons" (SimPhotons CSV or .lcph files) or "hits" (pixel hits in
+    SaturatedPhotons, or TracedPhotons from the hits workflow).
+    """
+
+    def __init__(self, archive: str = "archive/test", source: str = "hits"):
+        if source not in RECORD_DTYPES:
+            raise ValueError(f"Unknown replay source '{source}', expected 'photons' or 'hits'")
+        self.archive = Path(archive)
+        self.source = source
+        self.data = None
+
+    def load(self) -> pd.DataFrame:
+        """Read the source files and sort them by time of arrival.
+
+        Returns:
+            pd.DataFrame: Records with a time_ns column, sorted ascending.
+        """
+        if self.source == "photons":
+            sim_dir = self.archive / "SimPhotons"
+            # Only the record fields are loaded
+            columns = ["toa" if name == "time_ns" else name for name in RECORD_DTYPES["photons"].names]
+            data = PhotonReader(sim_dir, columns=columns).read()
+            if "toa" not in data.columns or len(data) == 0:
+                raise FileNotFoundError(f"No photon files in {sim_dir}")
+            data = data.rename(columns={"toa": "time_ns"})
+        else:
+            hit_files = sorted((self.archive / "SaturatedPhotons").glob("saturated_*.csv"))
+            if not hit_files:
+                hit_files = sorted((self.archive / "TracedPhotons").glob("traced_*.csv"))
+            dfs = [pd.read_csv(f) for f in hit_files]
+            dfs = [df for df in dfs if {"pixel_x", "pixel_y", "toa2"}.issubset(df.columns) and len(df) > 0]
+            if not dfs:
+                raise FileNotFoundError(f"No pixel hit files in {self.archive / 'SaturatedPhotons'} "
+                                        f"or {self.archive / 'TracedPhotons'}")
+            data = pd.concat(dfs, ignore_index=True).rename(columns={"toa2": "time_ns", "time_diff": "tot_ns"})
+            if "in_tpx3" in data.columns:
+                data = data[data["in_tpx3"].astype(bool)]
+            data = data.dropna(subset=["pixel_x", "pixel_y"])
+
+        self.data = data.sort_values("time_ns", kind="stable").reset_index(drop=True)
+        return self.data
+
+    def encode(self, data: pd.DataFrame, fmt: str = "tpx3") -> Tuple[np.ndarray, np.ndarray]:
+        """Encode time-ordered records as a byte stream.
+
+        Args:
+            data (pd.DataFrame): Records from load().
+            fmt (str): "tpx3" for 8-byte TPX3 packets with one TDC packet per pulse, placed
+                before the first hit at or after its trigger time (hits only), or "records"
+                for RECORD_DTYPES[source] structs.
+
+        Returns:
+            Tuple[np.ndarray, np.ndarray]: Encoded packets or records, one element per streamed
+            item, and the time_ns of each element.
+        """
+        if fmt == "records":
+            dtype = RECORD_DTYPES[self.source]
+            records = np.zeros(len(data), dtype=dtype)
+            for name in dtype.names:
+                if name in data.columns:
+                    records[name] = data[name].fillna(0).to_numpy()
+            return records, data["time_ns"].to_numpy()
+
+        if fmt != "tpx3":
+            raise ValueError(f"Unknown replay format '{fmt}', expected 'tpx3' or 'records'")
+        if self.source != "hits":
+            raise ValueError("TPX3 packets need pixel hits; use source='hits' or fmt='records'")
+
+        times = data["time_ns"].to_numpy()
+        tot = data["tot_ns"].to_numpy() if "tot_ns" in data.columns else np.ones(len(data))
+        packets = encode_pixels(data["pixel_x"].to_numpy(), data["pixel_y"].to_numpy(), times, tot)
+        if "pulse_id" not in data.columns or "pulse_time_ns" not in data.columns:
+            return packets, times
+
+        # One TDC packet per pulse, merged into the hit stream at its trigger time
+        pulses = data[["pulse_id", "pulse_time_ns"]].dropna().drop_duplicates("pulse_id")
+        pulses = pulses.sort_values(["pulse_time_ns", "pulse_id"], kind="stable")
+        trigger_ns = pulses["pulse_time_ns"].to_numpy(dtype=float)
+        tdc = encode_tdc(trigger_ns, pulses["pulse_id"].to_numpy())
+        position = np.searchsorted(times, trigger_ns, side="left")
+        return np.insert(packets, position, tdc), np.insert(times, position, trigger_ns)
+
+    def stream(self, target: Union[str, BinaryIO], rate_factor: float = 1.0, fmt: str = "tpx3",
+               chunk_size: int = 4096, verbosity: int = 1) -> ReplayReport:
+        """Send the loaded records, paced by their simulated timestamps.
+
+        Args:
+            target: "tcp://host:port", "unix:///path/to/socket", a file or FIFO path, or a
+                writable binary file object.
+            rate_factor (float): Simulated seconds per wall second; 0 sends as fast as the
+                consumer accepts.
+            fmt (str): "tpx3" or "records" (see encode).
+            chunk_size (int): Records per write. Pacing is per chunk.
+            verbosity (int): Print the report when >= 1.
+
+        Returns:
+            ReplayReport: Achieved throughput and consumer back-pressure.
+        """
+        if rate_factor < 0:
+            raise ValueError("rate_factor must be non-negative")
+        if chunk_size <= 0:
+            raise ValueError("chunk_size must be positive")
+        data = self.data if self.data is not None else self.load()
+        items, times = self.encode(data, fmt)
+
+        report = ReplayReport()
+        if len(items) > 0:
+            report.simulated_s = (times[-1] - times[0]) * 1e-9
+
+        write, close = _open_target(target)
+        try:
+            start = time.perf_counter()
+            for begin in range(0, len(items), chunk_size):
+                chunk = items[begin:begin + chunk_size]
+                if rate_factor > 0:
+                    due = start + (times[begin] - times[0]) * 1e-9 / rate_factor
+                    delay = due - time.perf_counter()
+                    if delay > 0:
+                        time.sleep(delay)
+                    elif -delay > 1e-3:
+                        report.late_chunks += 1
+                        report.max_lag_s = max(report.max_lag_s, -delay)
+
+                payload = chunk.tobytes()
+                before = time.perf_counter()
+                write(payload)
+                report.blocked_s += time.perf_counter() - before
+                report.records += len(chunk)
+                report.bytes += len(payload)
+            report.wall_s = time.perf_counter() - start
+        finally:
+            close()
+
+        if verbosity >= 1:
+            print(report)
+        return report
+
+
+def _open_target(target: Union[str, BinaryIO]):
+    """Return (write, close) callables for a replay target."""
+    if not isinstance(target, str):
+        return target.write, target.flush
+
+    if target.startswith("tcp://"):
+        host, port = target[len("tcp://"):].rsplit(":", 1)
+        sock = socket.create_connection((host, int(port)))
+    elif target.startswith("unix://"):
+        sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        sock.connect(target[len("unix://"):])
+    else:
+        # Files and FIFOs; opening a FIFO blocks until the consumer connects
+        f = open(target, "wb", buffering=0)
+        return f.write, f.close
+
+    def close():
+        sock.shutdown(socket.SHUT_WR)
+        sock.close()
+
+    return sock.sendall, close
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Replay a lumacam output set as a time-ordered stream")
+    parser.add_argument("archive", help="Archive directory of a finished simulation")
+    parser.add_argument("target", help="tcp://host:port, unix:///path, or a file/FIFO path")
+    parser.add_argument("--source", choices=sorted(RECORD_DTYPES), default="hits")
+    parser.add_argument("--format", choices=["tpx3", "records"], default="tpx3")
+    parser.add_argument("--rate", type=float, default=1.0,
+                        help="Simulated seconds per wall second (0 for unpaced)")
+    parser.add_argument("--chunk", type=int, default=4096, help="Records per write")
+    args = parser.parse_args()
+    Replay(args.archive, args.source).stream(args.target, args.rate, args.format, args.chunk)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,261 @@
+import argparse
+import re
+import time
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Optional
+
+import numpy as np
+import pandas as pd
+
+from lumacam.reader import COLUMNS, PhotonReader
+
+
+def _natural_key(path: Path):
+    """Sort batch files numerically (sim_2 before sim_10), keeping neutron order."""
+    return [int(part) if part.isdigit() else part for part in re.split(r"(\d+)", path.name)]
+
+
+class PulseSchedule:
+    """Neutron-to-pulse assignment as in Sim::ComputePulseStructure, generated lazily.
+
+    The flux over the SCINT_SIZE x SCINT_SIZE field of view gives the mean neutrons per pulse.
+    Below one, neutron n goes to pulse floor(n * (1 / mean)); otherwise every pulse takes
+    floor(mean + u) neutrons with u uniform in [0, 1). Pulse i triggers at i / freq.
+    """
+
+    def __init__(self, flux: float, freq: float, scint_size: float = 12.0, seed: Optional[int] = None):
+        """
+        Args:
+            flux: Neutron flux in n/cm²/s.
+            freq: Pulse frequency in Hz.
+            scint_size: Field of view width in cm (SCINT_SIZE).
+            seed: Seed for the per-pulse neutron counts.
+        """
+        if flux <= 0 or freq <= 0:
+            raise ValueError("Flux and frequency must be positive")
+        self.period_s = 1.0 / freq
+        self.mean = flux * scint_size ** 2 / freq
+        self.rng = np.random.default_rng(seed)
+        self.cumulative = np.zeros(0, dtype=np.int64)  # Neutrons in pulses 0..i
+
+    def pulse_ids(self, events: np.ndarray) -> np.ndarray:
+        """Pulse number of each event index (0-based, in generation order)."""
+        events = np.asarray(events, dtype=np.int64)
+        if self.mean < 1.0:
+            # Same rounding as the simulator's pulsesPerNeutron product
+            return np.floor(events * (1.0 / self.mean)).astype(np.int64)
+        needed = int(events.max()) + 1 if len(events) else 0
+        while len(self.cumulative) == 0 or self.cumulative[-1] < needed:
+            pulses = max(1024, int((needed - (self.cumulative[-1] if len(self.cumulative) else 0)) / self.mean) + 1)
+            counts = np.floor(self.mean + self.rng.random(pulses)).astype(np.int64)
+            start = self.cumulative[-1] if len(self.cumulative) else 0
+            self.cumulative = np.concatenate([self.cumulative, start + np.cumsum(counts)])
+        return np.searchsorted(self.cumulative, events, side="right")
+
+    def pulse_times(self, pulse_ids: np.ndarray) -> np.ndarray:
+        """Trigger time in ns of each pulse, rounded as the simulator computes it."""
+        return np.asarray(pulse_ids, dtype=float) * self.period_s * 1e9
+
+
+@dataclass
+class RetimeReport:
+    """Volume and speed of one re-timing pass."""
+    photons: int = 0
+    neutrons: int = 0
+    pulses: int = 0
+    files: int = 0
+    bytes: int = 0
+    wall_s: float = 0.0
+    max_buffered: int = 0  # Largest number of photons held back for time ordering
+
+    def __str__(self) -> str:
+        rate = self.photons / self.wall_s if self.wall_s > 0 else 0.0
+        mb_s = self.bytes / self.wall_s / 1e6 if self.wall_s > 0 else 0.0
+        return (f"Retime: {self.photons} photons of {self.neutrons} neutrons over {self.pulses} pulses "
+                f"in {self.wall_s:.3f} s\n"
+                f"  Output: {self.files} files, {self.bytes / 1e6:.2f} MB ({rate:.0f} photons/s, {mb_s:.2f} MB/s)\n"
+                f"  Peak time-ordering buffer: {self.max_buffered} photons")
+
+
+class Retimer:
+    """Reassign the neutrons of a finished output set to a new flux and pulse frequency.
+
+    Only the pulse structure changes between such runs: every photon keeps its delay toa - pulse_time_ns
+    behind its neutron's trigger, and neutrons are assigned to pulses in generation order. One streaming
+    pass rewrites pulse_id, pulse_time_ns and toa and writes time-ordered SimPhotons CSV files, so
+    pile-up and dead-time studies over flux and frequency need no new Geant4 run.
+
+    Neutrons are ordered by their event in the SimNeutrons summaries when present, which also keeps
+    the flux right for prescaled photon output; otherwise by neutron_id, which only counts neutrons
+    that reached the scintillator.
+
+    pulse_id is always the pulse number, i.e. pulse_time_ns * freq. The simulator numbers pulses
+    the same way at one or more neutrons per pulse. Below one neutron per pulse it numbers one
+    entry per neutron instead (Sim::ComputePulseStructure), so there its pulse_id follows the
+    neutron and skips no values, and only pulse_time_ns carries the trigger. Compare re-timed and
+    simulated low-rate output on pulse_time_ns, not pulse_id.
+    """
+
+    def __init__(self, archive: str, flux: float, freq: float, scint_size: float = 12.0,
+                 seed: Optional[int] = None):
+        """
+        Args:
+            archive: Archive directory of a finished simulation.
+            flux, freq, scint_size, seed: New pulse structure, see PulseSchedule.
+        """
+        self.archive = Path(archive)
+        self.schedule = PulseSchedule(flux, freq, scint_size, seed)
+        files = list((self.archive / "SimPhotons").glob("*.csv")) + list((self.archive / "SimPhotons").glob("*.lcph"))
+        self.files = sorted(files, key=_natural_key)
+        if not self.files:
+            raise FileNotFoundError(f"No photon files in {self.archive / 'SimPhotons'}")
+        self.summary = self._read_summary()
+        self.event_of = None
+        if self.summary is not None:
+            # neutron_id -> event position; events without hits have neutron_id -1
+            detected = self.summary[self.summary["neutron_id"] >= 0]
+            self.event_of = pd.Series(detected.index.to_numpy(), index=detected["neutron_id"].to_numpy())
+
+    def _read_summary(self) -> Optional[pd.DataFrame]:
+        files = sorted((self.archive / "SimNeutrons").glob("*_neutrons_*.csv"), key=_natural_key)
+        if not files:
+            return None
+        return pd.concat([pd.read_csv(f) for f in files], ignore_index=True)
+
+    def _events(self, neutron_id: np.ndarray, first_id: int) -> np.ndarray:
+        if self.event_of is not None:
+            events = self.event_of.reindex(neutron_id).to_numpy()
+            if np.isnan(events).any():
+                raise ValueError("Photon neutron_ids missing from the SimNeutrons summaries")
+            return events.astype(np.int64)
+        return np.asarray(neutron_id, dtype=np.int64) - first_id
+
+    def _retime(self, df: pd.DataFrame, events: np.ndarray) -> pd.DataFrame:
+        pulses = self.schedule.pulse_ids(events)
+        pulse_time = self.schedule.pulse_times(pulses)
+        df = df.copy()
+        df["toa"] = df["toa"].to_numpy(dtype=float) - df["pulse_time_ns"].to_numpy(dtype=float) + pulse_time
+        df["pulse_id"] = pulses
+        df["pulse_time_ns"] = pulse_time
+        return df
+
+    def run(self, output: str, chunk_rows: int = 1_000_000, rows_per_file: int = 10_000_000,
+            verbose: bool = True) -> RetimeReport:
+        """Write the re-timed output set.
+
+        Args:
+            output: Archive directory for the result (SimPhotons, and SimNeutrons when the source has it).
+            chunk_rows: Photons read per step.
+            rows_per_file: Photons per output CSV file.
+            verbose: Print the report.
+
+        Returns:
+            RetimeReport: Counts and throughput.
+        """
+        output = Path(output)
+        photon_dir = output / "SimPhotons"
+        photon_dir.mkdir(parents=True, exist_ok=True)
+        report = RetimeReport()
+        start = time.perf_counter()
+
+        writer = _CsvBatchWriter(photon_dir, "retimed", rows_per_file)
+        pending = None
+        first_id = None
+        last_event = -1
+        for chunk in PhotonReader(self.files).iter_chunks(chunk_rows):
+            if first_id is None:
+                first_id = int(chunk["neutron_id"].min())
+            events = self._events(chunk["neutron_id"].to_numpy(), first_id)
+            if events.min() < last_event:
+                raise ValueError("Photon files are not in neutron order (tiled binary output needs codec_tile_size 0)")
+            last_event = int(events.max())
+            chunk = self._retime(chunk, events)
+
+            # Photons never precede their trigger, and later chunks belong to this or later pulses,
+            # so everything before the trigger of the last neutron read is final
+            watermark = self.schedule.pulse_times(self.schedule.pulse_ids(np.array([last_event])))[0]
+            pending = chunk if pending is None else pd.concat([pending, chunk], ignore_index=True)
+            pending = pending.sort_values("toa", kind="stable", ignore_index=True)
+            ready = int(np.searchsorted(pending["toa"].to_numpy(), watermark, side="left"))
+            report.max_buffered = max(report.max_buffered, len(pending))
+            if ready > 0:
+                writer.write(pending.iloc[:ready])
+                pending = pending.iloc[ready:].reset_index(drop=True)
+        if pending is not None and len(pending) > 0:
+            writer.write(pending)
+        writer.close()
+
+        report.photons, report.files, report.bytes = writer.rows, len(writer.paths), writer.bytes
+        report.neutrons = last_event + 1
+        report.pulses = int(self.schedule.pulse_ids(np.array([last_event]))[0]) + 1 if last_event >= 0 else 0
+        if self.summary is not None:
+            self._write_summary(output / "SimNeutrons")
+        report.wall_s = time.perf_counter() - start
+        if verbose:
+            print(report)
+        return report
+
+    def _write_summary(self, directory: Path) -> None:
+        """Re-time the per-neutron summaries; first_toa moves with the trigger like toa."""
+        directory.mkdir(parents=True, exist_ok=True)
+        summary = self.summary.copy()
+        pulses = self.schedule.pulse_ids(np.arange(len(summary)))
+        pulse_time = self.schedule.pulse_times(pulses)
+        if "first_toa" in summary.columns:
+            hit = summary["photons"] > 0
+            summary.loc[hit, "first_toa"] += pulse_time[hit.to_numpy()] - summary.loc[hit, "pulse_time_ns"]
+        summary["pulse_id"] = pulses
+        summary["pulse_time_ns"] = pulse_time
+        summary.to_csv(directory / "retimed_neutrons_0.csv", index=False)
+
+
+class _CsvBatchWriter:
+    """Time-ordered SimPhotons CSV files of rows_per_file photons each."""
+
+    def __init__(self, directory: Path, base_name: str, rows_per_file: int):
+        self.directory, self.base_name, self.rows_per_file = directory, base_name, rows_per_file
+        self.paths = []
+        self.rows = self.bytes = self.file_rows = 0
+        self.handle = None
+
+    def write(self, df: pd.DataFrame) -> None:
+        df = df[[c for c in COLUMNS if c in df.columns]]
+        while len(df) > 0:
+            if self.handle is None:
+                path = self.directory / f"{self.base_name}_{len(self.paths)}.csv"
+                self.handle = open(path, "w", newline="")
+                self.paths.append(path)
+                self.file_rows = 0
+            take = min(len(df), self.rows_per_file - self.file_rows)
+            text = df.iloc[:take].to_csv(index=False, header=self.file_rows == 0)
+            self.handle.write(text)
+            self.bytes += len(text)
+            self.rows += take
+            self.file_rows += take
+            df = df.iloc[take:]
+            if self.file_rows >= self.rows_per_file:
+                self.close()
+
+    def close(self) -> None:
+        if self.handle is not None:
+            self.handle.close()
+            self.handle = None
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Re-time a lumacam output set for a new flux and pulse frequency")
+    parser.add_argument("archive", help="Archive directory of a finished simulation")
+    parser.add_argument("output", help="Archive directory for the re-timed output")
+    parser.add_argument("--flux", type=float, required=True, help="Neutron flux in n/cm²/s")
+    parser.add_argument("--freq", type=float, required=True, help="Pulse frequency in Hz")
+    parser.add_argument("--scint-size", type=float, default=12.0, help="Field of view width in cm")
+    parser.add_argument("--seed", type=int, default=None, help="Seed for the per-pulse neutron counts")
+    parser.add_argument("--rows-per-file", type=int, default=10_000_000)
+    args = parser.parse_args()
+    Retimer(args.archive, args.flux, args.freq, args.scint_size, args.seed).run(args.output,
+                                                                                 rows_per_file=args.rows_per_file)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,174 @@
+from pathlib import Path
+from typing import Callable, Optional, Sequence, Tuple, Union
+
+import numpy as np
+import pandas as pd
+
+# GPS energy units -> MeV
+ENERGY_UNITS = {"eV": 1e-6, "keV": 1e-3, "MeV": 1.0, "GeV": 1e3}
+
+_integrate = getattr(np, "trapezoid", None) or np.trapz
+
+# Effective sample size below this fraction of the neutrons is reported as too aggressive
+MIN_ESS_FRACTION = 0.1
+
+Spectrum = Union[Callable[[np.ndarray], np.ndarray], Tuple[Sequence[float], Sequence[float]], "Config"]
+
+
+class _Density:
+    """Unnormalized energy density on [emin, emax] (MeV), zero outside."""
+
+    def __init__(self, spectrum: Spectrum, energy_range: Optional[Tuple[float, float]] = None):
+        self.emin, self.emax = energy_range if energy_range is not None else (None, None)
+        if callable(spectrum):
+            self.function = spectrum
+        elif hasattr(spectrum, "energy_type"):
+            self._from_config(spectrum)
+        else:
+            energies, values = (np.asarray(v, dtype=float) for v in spectrum)
+            order = np.argsort(energies)
+            energies, values = energies[order], values[order]
+            self.function = lambda e: np.interp(e, energies, values, left=0.0, right=0.0)
+            self.emin = energies[0] if self.emin is None else self.emin
+            self.emax = energies[-1] if self.emax is None else self.emax
+        if self.emin is None or self.emax is None or not 0 < self.emin < self.emax:
+            raise ValueError("Spectrum needs a positive energy range; pass energy_range for callables")
+
+    def _from_config(self, config) -> None:
+        """GPS source spectrum of a Config: Lin (gradient * E + intercept) or Hist (User histogram)."""
+        scale = ENERGY_UNITS.get(config.energy_unit)
+        if scale is None:
+            raise ValueError(f"Unknown energy unit '{config.energy_unit}'")
+        if config.energy_type == "Lin":
+            emin, emax = config.energy_min * scale, config.energy_max * scale
+            gradient, intercept = config.energy_gradient or 0.0, config.energy_intercept or 0.0
+            # GPS evaluates the line in the configured unit
+            self.function = lambda e: np.where((e >= emin) & (e <= emax),
+                                               np.maximum(gradient * e / scale + intercept, 0.0), 0.0)
+        elif config.energy_type == "Hist" and config.energy_histogram:
+            # /gps/hist/point gives bin upper edges; the first point only sets the lower edge
+            edges = np.array([e for e, _ in config.energy_histogram], dtype=float) * scale
+            counts = np.array([w for _, w in config.energy_histogram[1:]], dtype=float)
+            density = counts / np.diff(edges)
+            emin, emax = edges[0], edges[-1]
+            self.function = lambda e: np.where((e > emin) & (e <= emax),
+                                               density[np.clip(np.searchsorted(edges, e) - 1, 0, len(density) - 1)],
+                                               0.0)
+        else:
+            raise ValueError(f"Cannot reweight a '{config.energy_type}' source; sample a Lin or Hist spectrum")
+        self.emin = emin if self.emin is None else self.emin
+        self.emax = emax if self.emax is None else self.emax
+
+    def __call__(self, energy: np.ndarray) -> np.ndarray:
+        energy = np.asarray(energy, dtype=float)
+        inside = (energy >= self.emin) & (energy <= self.emax)
+        return np.where(inside, self.function(np.where(inside, energy, self.emin)), 0.0)
+
+
+class SpectrumReweighter:
+    """Per-neutron weights target(E) / sampling(E) that turn one simulated run into any target spectrum.
+
+    Simulate once with a broad, known sampling spectrum (e.g. a Lin or Hist Config), then apply
+    the weights to photon tables or neutron summaries keyed by neutronEnergy, or write them as a
+    table for /lumacam/reweightFile so the online frames and TOF cube are filled reweighted.
+    Both spectra are normalized to unit integral, so a weighted sum is a result per target neutron;
+    target flux outside the sampling range cannot be recovered and is reported as missing coverage.
+
+    Example:
+        reweighter = SpectrumReweighter(target=(energies, flux), sampling=Config.neutrons_tof(0.5, 20))
+        photons = reweighter.apply(sim.read_photons())
+        reweighter.diagnostics(sim.read_neutron_summary())
+    """
+
+    def __init__(self, target: Spectrum, sampling: Spectrum,
+                 energy_range: Optional[Tuple[float, float]] = None, grid_points: int = 20000):
+        """
+        Args:
+            target: Spectrum to produce results for.
+            sampling: Spectrum the run was simulated with.
+                Each is a callable density of energy (MeV), an (energies, density) table interpolated
+                linearly, or a Config whose Lin or Hist GPS spectrum is used.
+            energy_range: (min, max) MeV for callables without an intrinsic range.
+            grid_points: Log-spaced points for the normalization integrals.
+        """
+        self.sampling = _Density(sampling, energy_range)
+        self.target = _Density(target, energy_range if energy_range is not None else
+                               ((self.sampling.emin, self.sampling.emax) if callable(target) else None))
+
+        emin = min(self.sampling.emin, self.target.emin)
+        emax = max(self.sampling.emax, self.target.emax)
+        grid = np.geomspace(emin, emax, grid_points)
+        sampling_density, target_density = self.sampling(grid), self.target(grid)
+        self._sampling_norm = _integrate(sampling_density, grid)
+        self._target_norm = _integrate(target_density, grid)
+        if self._sampling_norm <= 0 or self._target_norm <= 0:
+            raise ValueError("Sampling and target spectra must have positive integrals")
+        uncovered = np.where(sampling_density > 0, 0.0, target_density)
+        self.coverage = 1.0 - _integrate(uncovered, grid) / self._target_norm
+
+    def weight(self, energy: Union[float, np.ndarray]) -> np.ndarray:
+        """Weight of neutrons sampled at energy (MeV); 0 where the sampling spectrum vanishes."""
+        sampling = self.sampling(energy) / self._sampling_norm
+        target = self.target(energy) / self._target_norm
+        with np.errstate(divide="ignore", invalid="ignore"):
+            return np.where(sampling > 0, target / sampling, 0.0)
+
+    def apply(self, df: pd.DataFrame, energy_column: str = "neutronEnergy",
+              weight_column: str = "weight") -> pd.DataFrame:
+        """Return a copy of df whose weight column is multiplied by the spectrum weight.
+
+        Rows without a weight column (unweighted runs) start from 1.
+        """
+        if energy_column not in df.columns:
+            raise KeyError(f"Reweighting needs the '{energy_column}' column")
+        out = df.copy()
+        base = out[weight_column].to_numpy(dtype=float) if weight_column in out.columns else 1.0
+        out[weight_column] = base * self.weight(out[energy_column].to_numpy(dtype=float))
+        return out
+
+    def diagnostics(self, neutrons: Union[pd.DataFrame, np.ndarray], energy_column: str = "neutronEnergy",
+                    verbose: bool = True) -> dict:
+        """Effective sample size of the reweighted neutrons.
+
+        Args:
+            neutrons: Neutron energies (MeV), a neutron summary, or a photon table (one entry per
+                neutron_id is used, since all photons of a neutron share its weight).
+            verbose: Print the diagnostics and warn when the reweighting is too aggressive.
+
+        Returns:
+            dict: neutrons, effective_sample_size, ess_fraction, max_weight, coverage.
+        """
+        if isinstance(neutrons, pd.DataFrame):
+            # Photon tables repeat the neutron per photon; summaries have one row per event
+            if "event_id" not in neutrons.columns and "neutron_id" in neutrons.columns:
+                neutrons = neutrons.drop_duplicates("neutron_id")
+            base = neutrons["weight"].to_numpy(dtype=float) if "weight" in neutrons.columns else 1.0
+            weights = base * self.weight(neutrons[energy_column].to_numpy(dtype=float))
+        else:
+            weights = self.weight(np.asarray(neutrons, dtype=float))
+        count = len(weights)
+        sum_squares = np.sum(weights ** 2)
+        ess = np.sum(weights) ** 2 / sum_squares if sum_squares > 0 else 0.0
+        result = {"neutrons": count, "effective_sample_size": float(ess),
+                  "ess_fraction": float(ess / count) if count else 0.0,
+                  "max_weight": float(weights.max()) if count else 0.0, "coverage": float(self.coverage)}
+        if verbose:
+            print(f"Spectrum reweighting: ESS {ess:.1f} of {count} neutrons ({100 * result['ess_fraction']:.1f}%), "
+                  f"max weight {result['max_weight']:.3g}, target coverage {100 * self.coverage:.1f}%")
+            if result["ess_fraction"] < MIN_ESS_FRACTION:
+                print(f"Warning: effective sample size below {100 * MIN_ESS_FRACTION:.0f}% of the neutrons; "
+                      f"the sampling spectrum covers the target poorly")
+            if self.coverage < 0.99:
+                print(f"Warning: {100 * (1 - self.coverage):.1f}% of the target spectrum lies where nothing was sampled")
+        return result
+
+    def write_table(self, path: Union[str, Path], points: int = 2000) -> Path:
+        """Write the weights as an "energy weight" table for /lumacam/reweightFile (Config.reweight_table).
+
+        Points are log-spaced over the sampling range; the simulation interpolates linearly in log(E).
+        """
+        path = Path(path)
+        energies = np.geomspace(self.sampling.emin, self.sampling.emax, points)
+        table = np.column_stack([energies, self.weight(energies)])
+        np.savetxt(path, table, fmt="%.9g", header="energy_MeV weight (target/sampling)")
+        return path
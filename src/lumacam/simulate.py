@@ -8,11 +8,14 @@ from typing import Optional, Tuple, List
 from pathlib import Path
 from enum import IntEnum
 from tqdm.notebook import tqdm
+import numpy as np
 import pandas as pd
 import threading
 import queue
 import time
 import glob
+import json
+from lumacam.reader import PhotonReader, MAGIC
 
 class VerbosityLevel(IntEnum):
     """Verbosity levels for simulation output."""
@@ -58,12 +61,57 @@ class Config:
     flux: Optional[float] = None  # Neutron flux in n/cm²/s
     freq: Optional[float] = None  # Pulse frequency in Hz
     
+    # Source importance sampling (output gains a 'weight' column)
+    importance_mode: str = "none"  # "none", "map" (user file) or "edge" (band around the sample edge)
+    importance_map: Optional[str] = None  # Text file: "nx ny" then ny rows of nx values over the GPS plane
+    importance_edge_width: float = 2.0  # Half-width of the edge band in mm
+    importance_edge_boost: float = 10.0  # Relative importance inside the edge band
+    reweight_table: Optional[str] = None  # "energy weight" table (SpectrumReweighter.write_table) for frames and TOF cube
+    
+    # Neutron termination, written as /lumacam/neutronKill/<key> <value>
+    # e.g. {"sampleEnergy": "0.5 eV", "housingTime": "1 ms", "maxScatters": 200, "rouletteSurvival": 0.5}
+    neutron_kill: Optional[dict] = None
+    
     sample_material: str = "G4_Galactic"  # Material of the sample
     scintillator: str = "EJ200"  # Scintillator type: PVT, EJ-200, GS20
     sample_thickness: float = 0.2  # Sample thickness in cm (default 0.2 cm = 200 microns)
     sample_width: float = 12.0  # Sample width in cm (default 12 cm)  
     scintillator_thickness: float = 20  # Scintillator thickness in mm (default is 20 mm)
     csv_batch_size: int = 0
+    monitor_mode: str = "volume"  # "volume" (MonitorPhys layer) or "exitFace" (OpBoundary status at scintillator top)
+    optical_fast_path: str = "off"  # Trivial optical surfaces: "off", "on" (shortcut) or "check" (compare with stock OpBoundary)
+    write_photons: bool = True  # Per-photon CSV output in SimPhotons
+    lens_acceptance: bool = True  # Record only photons heading into the lens window
+    neutron_plane: bool = False  # No optical physics; record neutrons entering the scintillator (see read_neutron_plane)
+    fast_scint_models: bool = False  # Fast n-p / 6Li(n,t) reactions with quenched light instead of HP in the scintillator
+    range_table_light: bool = False  # Range-table quenched light for p, t, alpha in the scintillator instead of EM stepping
+    photon_format: str = "csv"  # "csv" or "binary" (quantized .lcph files, read back transparently)
+    codec_position_grid: float = 1.0  # Binary position grid in um
+    codec_time_tick: float = 0.001  # Binary time tick in ns
+    codec_block_photons: int = 65536  # Photons per indexed binary block (unit of block skipping in PhotonReader)
+    codec_tile_size: float = 0.0  # Binary x/y tile width in mm for region-of-interest reads (0 = untiled)
+    detail_prescale: int = 1  # Write photon records for a reproducible 1-in-K subset of events
+    neutron_summary: bool = False  # Per-neutron summary rows for every event in SimNeutrons
+    notify_file: Optional[str] = None  # JSON-lines file announcing each closed photon batch (see follow_batches)
+    perf_counters: bool = False  # Hardware counters per run phase in the run summary and SimPerf
+    
+    # Sparse per-exposure frames for frame-based cameras (written to SimFrames)
+    frame_grid: Optional[Tuple[int, int]] = None  # (nx, ny) pixel grid; None disables frame output
+    frame_fov: float = 0.0  # Field of view on the scintillator exit face in mm (0 uses the scintillator size)
+    frame_pulses: int = 1  # Pulse periods integrated into each frame
+    frame_exposure: float = 0.0  # Exposure from frame start in ns (frame period when not pulsed, 0 for whole period)
+    
+    # Online (x, y, TOF) cube for Bragg-edge imaging (written to SimTOF)
+    tof_cube_grid: Optional[Tuple[int, int]] = None  # (nx, ny) pixel grid; None disables the cube
+    tof_cube_fov: float = 0.0  # Field of view on the scintillator exit face in mm (0 uses the scintillator size)
+    tof_cube_bins: int = 1000  # Number of TOF bins
+    tof_cube_range: Tuple[float, float] = (1e3, 5e7)  # TOF range in ns relative to the pulse time
+    tof_cube_log: bool = True  # Log-spaced TOF bins
+    
+    # Tomography: rotate the sample about the vertical axis between sub-runs (index in SimTomo)
+    tomo_angles: Optional[Tuple[float, float, int]] = None  # (start, stop, n) in degrees, stop excluded; None for one projection
+    tomo_worker: Tuple[int, int] = (0, 1)  # (index, count): run angles with k % count == index in this process
+    
     # Ion parameters for radioactive decay
     ion_z: Optional[int] = None  # Atomic number
     ion_a: Optional[int] = None  # Mass number
@@ -384,6 +432,49 @@ class Config:
 /lumacam/freq {self.freq}
 """
 
+        # Add source importance sampling
+        if self.importance_mode != "none":
+            macro_content += f"/lumacam/importanceMode {self.importance_mode}\n"
+            if self.importance_map is not None:
+                macro_content += f"/lumacam/importanceMap {os.path.abspath(self.importance_map)}\n"
+            macro_content += f"/lumacam/importanceEdgeWidth {self.importance_edge_width} mm\n"
+            macro_content += f"/lumacam/importanceEdgeBoost {self.importance_edge_boost}\n"
+
+        # Fill the online accumulators for a target spectrum
+        if self.reweight_table is not None:
+            macro_content += f"/lumacam/reweightFile {os.path.abspath(self.reweight_table)}\n"
+
+        # Add sparse frame output
+        if self.frame_grid is not None:
+            macro_content += f"""
+/lumacam/frames/enable true
+/lumacam/frames/grid {self.frame_grid[0]} {self.frame_grid[1]}
+/lumacam/frames/fov {self.frame_fov} mm
+/lumacam/frames/pulsesPerFrame {self.frame_pulses}
+/lumacam/frames/exposure {self.frame_exposure} ns
+"""
+
+        # Add TOF cube output
+        if self.tof_cube_grid is not None:
+            macro_content += f"""
+/lumacam/tofCube/enable true
+/lumacam/tofCube/grid {self.tof_cube_grid[0]} {self.tof_cube_grid[1]}
+/lumacam/tofCube/fov {self.tof_cube_fov} mm
+/lumacam/tofCube/bins {self.tof_cube_bins}
+/lumacam/tofCube/tofMin {self.tof_cube_range[0]} ns
+/lumacam/tofCube/tofMax {self.tof_cube_range[1]} ns
+/lumacam/tofCube/logBins {str(self.tof_cube_log).lower()}
+"""
+
+        # Add neutron termination thresholds
+        if self.neutron_kill:
+            for key, value in self.neutron_kill.items():
+                macro_content += f"/lumacam/neutronKill/{key} {value}\n"
+
+        # Announce closed batch files for pipelined processing
+        if self.notify_file:
+            macro_content += f"/lumacam/notifyFile {Path(self.notify_file).resolve()}\n"
+
         macro_content += f"""
 /gps/position {self.position_x} {self.position_y} {self.position_z} {self.position_unit}
 /gps/direction {self.direction_x} {self.direction_y} {self.direction_z}
@@ -401,9 +492,31 @@ class Config:
 /lumacam/scintThickness {self.scintillator_thickness} cm
 /lumacam/sampleMaterial {self.sample_material}
 /lumacam/batchSize {self.csv_batch_size}
+/lumacam/monitorMode {self.monitor_mode}
+/lumacam/opticalFastPath {self.optical_fast_path}
+/lumacam/photonOutput {str(self.write_photons).lower()}
+/lumacam/lensAcceptance {str(self.lens_acceptance).lower()}
+/lumacam/fastScintModels {str(self.fast_scint_models).lower()}
+/lumacam/rangeTableLight {str(self.range_table_light).lower()}
+/lumacam/photonFormat {self.photon_format}
+/lumacam/codecPositionGrid {self.codec_position_grid} um
+/lumacam/codecTimeTick {self.codec_time_tick} ns
+/lumacam/codecBlockPhotons {self.codec_block_photons}
+/lumacam/codecTileSize {self.codec_tile_size} mm
+/lumacam/detailPrescale {self.detail_prescale}
+/lumacam/neutronSummary {str(self.neutron_summary).lower()}
+/lumacam/perfCounters {str(self.perf_counters).lower()}
 /control/verbose 2
-/run/beamOn {self.num_events}
 """
+
+        # Tomography runs num_events at every angle of this worker
+        if self.tomo_angles is not None:
+            macro_content += f"""/lumacam/tomo/angles {self.tomo_angles[0]} {self.tomo_angles[1]} {self.tomo_angles[2]}
+/lumacam/tomo/worker {self.tomo_worker[0]} {self.tomo_worker[1]}
+/lumacam/tomo/beamOn {self.num_events}
+"""
+        else:
+            macro_content += f"/run/beamOn {self.num_events}\n"
         with open(output_file, 'w') as f:
             f.write(macro_content.strip())
             
@@ -438,6 +551,8 @@ class Config:
         pulse_info = ""
         if self.flux is not None and self.freq is not None:
             pulse_info = f"  Neutron Flux: {self.flux} n/cm²/s\n  Pulse Frequency: {self.freq/1000} kHz\n"
+        if self.importance_mode != "none":
+            pulse_info += f"  Importance Sampling: {self.importance_mode}\n"
             
         return (
             f"Configuration:\n"
@@ -462,6 +577,111 @@ class Config:
         """Return a string representation of the configuration."""
         return str(self)
         
+def read_photons_binary(path: str) -> pd.DataFrame:
+    """Decode a quantized photon file written with /lumacam/photonFormat binary
+    (see PhotonCodec.cc for the layout).
+
+    Args:
+        path (str): Path to a SimPhotons *.lcph file.
+
+    Returns:
+        pd.DataFrame: Photons with the same columns as the CSV output.
+    """
+    with open(path, "rb") as f:
+        if f.read(8) != MAGIC:
+            raise ValueError(f"{path} is not a lumacam binary photon file")
+    return PhotonReader(path).read()
+
+def follow_batches(notify_file: str, poll_interval: float = 0.2, timeout: Optional[float] = None):
+    """Yield photon batches as lumacam closes them, for overlapping simulation and tracing.
+
+    Run the simulation in the background (e.g. Simulate.run in a thread, with Config.notify_file
+    set) and consume batch k here while lumacam produces batch k + 1.
+
+    Args:
+        notify_file (str): The JSON-lines notification file given as Config.notify_file.
+        poll_interval (float): Seconds between checks for new lines.
+        timeout (Optional[float]): Give up after this many seconds without a new line.
+
+    Yields:
+        dict: One entry per closed batch with run, batch, path, format, rows,
+        neutron_id_min and neutron_id_max. Iteration stops after the run_end notice.
+    """
+    path = Path(notify_file)
+    position = 0
+    last_activity = time.time()
+    while True:
+        lines = []
+        if path.exists():
+            with open(path, "rb") as f:
+                f.seek(position)
+                chunk = f.read()
+            # Only consume complete lines; a partial line is re-read on the next poll
+            complete = chunk[:chunk.rfind(b"\n") + 1]
+            position += len(complete)
+            lines = complete.decode().splitlines()
+        for line in lines:
+            notice = json.loads(line)
+            if notice.get("type") == "run_end":
+                return
+            yield notice
+        if lines:
+            last_activity = time.time()
+        elif timeout is not None and time.time() - last_activity > timeout:
+            raise TimeoutError(f"No batch notification in {notify_file} for {timeout} s")
+        else:
+            time.sleep(poll_interval)
+
+def _tag_tomo_angle(df: pd.DataFrame, path: Path) -> pd.DataFrame:
+    """Add an angle_index column to photons read from a tomography sub-run file (<base>_angle<k>...)."""
+    match = re.search(r'_angle(\d+)', Path(path).name)
+    if match:
+        df["angle_index"] = int(match.group(1))
+    return df
+
+
+def read_tof_cube(path: str) -> Tuple[np.ndarray, np.ndarray]:
+    """Decode a tiled TOF cube file written by lumacam (see TofCubeAccumulator.cc for the layout).
+
+    Args:
+        path (str): Path to a *_tofcube_<run>.bin file.
+
+    Returns:
+        Tuple[np.ndarray, np.ndarray]: Dense float32 cube of shape (nx, ny, nt) and the nt + 1 TOF edges in ns.
+    """
+    data = Path(path).read_bytes()
+    if data[:8] != b"LCTOFCB1":
+        raise ValueError(f"{path} is not a lumacam TOF cube")
+    nx, ny, nt, tile_xy, tile_t, _ = np.frombuffer(data, dtype="<i4", count=6, offset=8)
+    offset = 8 + 6 * 4 + 8  # header ints and fov
+    edges = np.frombuffer(data, dtype="<f8", count=nt + 1, offset=offset).copy()
+    offset += (nt + 1) * 8
+    n_tiles = int(np.frombuffer(data, dtype="<u8", count=1, offset=offset)[0])
+    offset += 8
+
+    # Tiles are padded to whole tile multiples, then cropped
+    padded = np.zeros((-(-nx // tile_xy) * tile_xy, -(-ny // tile_xy) * tile_xy, -(-nt // tile_t) * tile_t),
+                      dtype=np.float32)
+    tile_size = tile_xy * tile_xy * tile_t
+    sparse_dtype = np.dtype([("offset", "<u2"), ("value", "<f4")])
+    for _ in range(n_tiles):
+        tx, ty, tt = np.frombuffer(data, dtype="<i4", count=3, offset=offset)
+        encoding = data[offset + 12]
+        count = int(np.frombuffer(data, dtype="<u4", count=1, offset=offset + 13)[0])
+        offset += 17
+        tile = np.zeros(tile_size, dtype=np.float32)
+        if encoding == 0:
+            tile[:] = np.frombuffer(data, dtype="<f4", count=count, offset=offset)
+            offset += count * 4
+        else:
+            entries = np.frombuffer(data, dtype=sparse_dtype, count=count, offset=offset)
+            tile[entries["offset"]] = entries["value"]
+            offset += count * sparse_dtype.itemsize
+        padded[tx * tile_xy:(tx + 1) * tile_xy,
+               ty * tile_xy:(ty + 1) * tile_xy,
+               tt * tile_t:(tt + 1) * tile_t] = tile.reshape(tile_xy, tile_xy, tile_t)
+    return padded[:nx, :ny, :nt], edges
+
 class Simulate:
     """Class to simulate the lumacam executable."""
     def __init__(self, archive: str = "archive/test"):
@@ -473,15 +693,25 @@ class Simulate:
         
         self.sim_dir = self.archive / "SimPhotons"
         self.sim_dir.mkdir(exist_ok=True, parents=True)
+        self.frames_dir = self.archive / "SimFrames"
+        self.tof_dir = self.archive / "SimTOF"
+        self.neutrons_dir = self.archive / "SimNeutrons"
+        self.losses_dir = self.archive / "SimLosses"
+        self.tomo_dir = self.archive / "SimTomo"
+        self.perf_dir = self.archive / "SimPerf"
 
         with resources.path('G4LumaCam', 'bin') as bin_path:
-            self.lumacam_executable = os.path.join(bin_path, "lumacam")
+            # Prefer the headless batch build, which skips UI/vis initialization
+            self.lumacam_executable = os.path.join(bin_path, "lumacam-batch")
+            if not os.path.exists(self.lumacam_executable):
+                self.lumacam_executable = os.path.join(bin_path, "lumacam")
 
     def _process_output(self, process, output_queue, verbosity):
         """Process the output from the simulation in real-time."""
         event_pattern = re.compile(r'--> Event (\d+) starts\.')
         final_event_pattern = re.compile(r'Simulating Event: (\d+)')
-        cleanup_pattern = re.compile(r'Graphics systems deleted\.')
+        # Printed once per run by both lumacam and lumacam-batch, so each run completes exactly once
+        cleanup_pattern = re.compile(r'### Run \d+ Ended ###')
         
         while True:
             line = process.stdout.readline()
@@ -511,7 +741,7 @@ class Simulate:
                     output_queue.put(('output', line))
 
     def clear_subfolders(self, verbosity: VerbosityLevel = VerbosityLevel.BASIC):
-        """Remove all contents of SimPhotons subfolder if it exists.
+        """Remove all contents of the SimPhotons, SimFrames, SimTOF, SimNeutrons, SimLosses, SimTomo and SimPerf subfolders if they exist.
         This ensures that old simulation data does not interfere with new runs.
         Args:
             verbosity (VerbosityLevel): Level of verbosity for print statements.           
@@ -524,6 +754,203 @@ class Simulate:
                     shutil.rmtree(item)
             if verbosity >= VerbosityLevel.DETAILED:
                 print(f"Cleared contents of {self.sim_dir}")
+        for output_dir in (self.frames_dir, self.tof_dir, self.neutrons_dir, self.losses_dir, self.tomo_dir,
+                           self.perf_dir):
+            if output_dir.exists():
+                shutil.rmtree(output_dir)
+
+    def read_frames(self) -> pd.DataFrame:
+        """Read the sparse frames written with frame output enabled.
+
+        Returns:
+            pd.DataFrame: COO rows with columns frame_id, frame_start_ns, pixel_x, pixel_y, counts,
+            concatenated over runs. A frame can appear in several row blocks if it was written early.
+        """
+        frame_files = sorted(self.frames_dir.glob("*_frames_*.csv")) if self.frames_dir.exists() else []
+        if not frame_files:
+            return pd.DataFrame(columns=["frame_id", "frame_start_ns", "pixel_x", "pixel_y", "counts"])
+        return pd.concat([pd.read_csv(f, comment="#") for f in frame_files], ignore_index=True)
+
+    def read_manifest(self, run: int = 0) -> dict:
+        """Read the output manifest of a run (prescale, event counts, photon files and summary file).
+
+        Photon records of a prescaled run cover 1 in manifest["prescale"] events, so per-photon
+        rates estimated from them must be multiplied by the prescale.
+
+        Args:
+            run (int): Geant4 run ID.
+
+        Returns:
+            dict: Parsed manifest; paths are relative to the archive directory.
+        """
+        manifest_files = sorted(self.sim_dir.glob(f"*_manifest_{run}.json"))
+        if not manifest_files:
+            raise FileNotFoundError(f"No manifest for run {run} in {self.sim_dir}")
+        return json.loads(manifest_files[0].read_text())
+
+    def read_neutron_summary(self) -> pd.DataFrame:
+        """Read the per-neutron summaries written with neutron_summary enabled.
+
+        Returns:
+            pd.DataFrame: One row per event with photon count, summed photon weight, weighted
+            centroid, first arrival and whether the event's photon records were written (detailed).
+        """
+        summary_files = sorted(self.neutrons_dir.glob("*_neutrons_*.csv")) if self.neutrons_dir.exists() else []
+        if not summary_files:
+            return pd.DataFrame()
+        return pd.concat([pd.read_csv(f) for f in summary_files], ignore_index=True)
+
+    def compare_light_yield(self, reference: str, bins: int = 50) -> pd.DataFrame:
+        """Compare the per-neutron light-yield spectrum with another archive, e.g. fast models vs full HP.
+
+        Both archives need neutron_summary output. Spectra are the weighted photon count per neutron,
+        normalized to the number of neutrons simulated, on common bin edges.
+
+        Args:
+            reference (str): Archive of the reference run.
+            bins (int): Number of light-yield bins.
+
+        Returns:
+            pd.DataFrame: Columns photons_min, photons_max, spectrum, reference and ratio.
+        """
+        summary = self.read_neutron_summary()
+        ref_files = sorted((Path(reference) / "SimNeutrons").glob("*_neutrons_*.csv"))
+        ref_summary = pd.concat([pd.read_csv(f) for f in ref_files], ignore_index=True) if ref_files else pd.DataFrame()
+        if summary.empty or ref_summary.empty:
+            raise FileNotFoundError("compare_light_yield needs neutron_summary output in both archives")
+
+        light = summary["photon_weight"].to_numpy()
+        ref_light = ref_summary["photon_weight"].to_numpy()
+        edges = np.linspace(0.0, max(light.max(), ref_light.max()), bins + 1)
+        spectrum = np.histogram(light, bins=edges)[0] / len(light)
+        ref_spectrum = np.histogram(ref_light, bins=edges)[0] / len(ref_light)
+        with np.errstate(divide="ignore", invalid="ignore"):
+            ratio = np.where(ref_spectrum > 0, spectrum / ref_spectrum, np.nan)
+
+        ks = np.max(np.abs(np.cumsum(spectrum) - np.cumsum(ref_spectrum)))
+        print(f"Mean light yield: {light.mean():.1f} vs {ref_light.mean():.1f} photons/neutron "
+              f"(ratio {light.mean() / ref_light.mean():.3f}), KS distance {ks:.4f}")
+        return pd.DataFrame({"photons_min": edges[:-1], "photons_max": edges[1:], "spectrum": spectrum,
+                             "reference": ref_spectrum, "ratio": ratio})
+
+    def read_optical_losses(self) -> pd.DataFrame:
+        """Read the per-run optical photon fate counts.
+
+        Returns:
+            pd.DataFrame: Columns scintillator, depth_min_mm, depth_max_mm, cause, photons, run.
+            Causes are bulk_absorption, tape_absorption, housing_absorption, other_absorption,
+            side_escape, outside_lens, reached_monitor and other; depth is the photon emission
+            depth measured from the scintillator back face.
+        """
+        loss_files = sorted(self.losses_dir.glob("*_losses_*.csv")) if self.losses_dir.exists() else []
+        if not loss_files:
+            return pd.DataFrame(columns=["scintillator", "depth_min_mm", "depth_max_mm", "cause", "photons", "run"])
+        return pd.concat([pd.read_csv(f).assign(run=int(f.stem.rsplit("_", 1)[1])) for f in loss_files],
+                         ignore_index=True)
+
+    def read_perf_counters(self) -> pd.DataFrame:
+        """Read the per-phase performance counters written with perf_counters enabled.
+
+        Phases are exclusive: init (run setup until the first event), event_loop (tracking),
+        sd (EventProcessor hit processing) and output (file writes). Counters that could not
+        be opened are NaN, and per-hit sd timing is only split out when rdpmc is available.
+
+        Returns:
+            pd.DataFrame: Columns phase, entries, seconds, cycles, instructions, cache_misses,
+            branch_misses, run and ipc.
+        """
+        perf_files = sorted(self.perf_dir.glob("*_perf_*.csv")) if self.perf_dir.exists() else []
+        if not perf_files:
+            return pd.DataFrame(columns=["phase", "entries", "seconds", "cycles", "instructions",
+                                         "cache_misses", "branch_misses", "run", "ipc"])
+        perf = pd.concat([pd.read_csv(f).assign(run=int(f.stem.rsplit("_", 1)[1])) for f in perf_files],
+                         ignore_index=True)
+        perf["ipc"] = perf["instructions"] / perf["cycles"]
+        return perf
+
+    def read_photons(self, columns: Optional[List[str]] = None,
+                     neutron_id: Optional[Tuple[Optional[int], Optional[int]]] = None,
+                     pulse_id: Optional[Tuple[Optional[int], Optional[int]]] = None,
+                     toa: Optional[Tuple[Optional[float], Optional[float]]] = None,
+                     neutron_energy: Optional[Tuple[Optional[float], Optional[float]]] = None,
+                     x: Optional[Tuple[Optional[float], Optional[float]]] = None,
+                     y: Optional[Tuple[Optional[float], Optional[float]]] = None,
+                     threads: int = 0) -> pd.DataFrame:
+        """Load selected columns and rows of the SimPhotons output without reading whole files.
+
+        Binary (.lcph) blocks outside the requested ranges are skipped unread; see
+        lumacam.reader.PhotonReader, which also offers chunked iteration. For region-of-interest
+        reads over x and y, write the run with Config.codec_tile_size so blocks cover one tile each.
+
+        Args:
+            columns (Optional[List[str]]): Columns to load, default all.
+            neutron_id, pulse_id, toa, neutron_energy, x, y: Inclusive (min, max) ranges; toa in ns,
+                neutron_energy in MeV, x and y in mm. None on either side leaves it open.
+            threads (int): Decoder threads, 0 for one per core.
+
+        Returns:
+            pd.DataFrame: Matching photons, with angle_index for tomography runs.
+        """
+        files = sorted(list(self.sim_dir.glob("*.csv")) + list(self.sim_dir.glob("*.lcph")))
+        dfs = []
+        for path in files:
+            df = PhotonReader(path, columns=columns, neutron_id=neutron_id, pulse_id=pulse_id, toa=toa,
+                              neutron_energy=neutron_energy, x=x, y=y, threads=threads).read()
+            if len(df) > 0:
+                dfs.append(_tag_tomo_angle(df, path))
+        if not dfs:
+            return PhotonReader([], columns=columns).read()
+        return pd.concat(dfs, ignore_index=True)
+
+    def read_neutron_plane(self, **kwargs) -> pd.DataFrame:
+        """Read the neutrons recorded at the scintillator front in neutron_plane mode.
+
+        Neutron-plane runs store one record per neutron track in the photon record layout;
+        this renames the columns to their meaning there.
+
+        Args:
+            **kwargs: Passed to read_photons (row ranges, threads).
+
+        Returns:
+            pd.DataFrame: Columns track_id, parent_id, neutron_id, pulse_id, pulse_time_ns, x, y, z,
+            dx, dy, dz, time_ns and energy at entry (mm, ns, MeV), first_process and vx, vy, vz of the
+            first interaction in the scintillator (exit point and "none" without one), source_x/y/z
+            (last interaction of the primary neutron in the sample, or the source vertex if it crossed
+            the sample without one), neutronEnergy and weight if present.
+        """
+        df = self.read_photons(**kwargs)
+        return df.drop(columns=["wavelength"], errors="ignore").rename(columns={
+            "id": "track_id", "toa": "time_ns", "parentEnergy": "energy", "parentName": "first_process",
+            "px": "vx", "py": "vy", "pz": "vz", "nx": "source_x", "ny": "source_y", "nz": "source_z"})
+
+    def read_tomo_angles(self) -> pd.DataFrame:
+        """Read the angle index of a tomography scan.
+
+        Every angle is a separate Geant4 run whose photon, frame, TOF cube, summary and loss files
+        are named after its base_name, so per-angle projections can be selected by that prefix.
+
+        Returns:
+            pd.DataFrame: Columns angle_index, angle_deg, base_name over all workers, sorted by angle_index.
+        """
+        index_files = sorted(self.tomo_dir.glob("*_angles_*.csv")) if self.tomo_dir.exists() else []
+        if not index_files:
+            return pd.DataFrame(columns=["angle_index", "angle_deg", "base_name"])
+        angles = pd.concat([pd.read_csv(f) for f in index_files], ignore_index=True)
+        return angles.sort_values("angle_index", ignore_index=True)
+
+    def read_tof_cube(self, run: int = 0) -> Tuple[np.ndarray, np.ndarray]:
+        """Read the (x, y, TOF) cube accumulated during a run.
+
+        Args:
+            run (int): Geant4 run ID of the cube to read.
+
+        Returns:
+            Tuple[np.ndarray, np.ndarray]: Dense float32 cube of shape (nx, ny, nt) and the nt + 1 TOF edges in ns.
+        """
+        cube_files = sorted(self.tof_dir.glob(f"*_tofcube_{run}.bin")) if self.tof_dir.exists() else []
+        if not cube_files:
+            raise FileNotFoundError(f"No TOF cube for run {run} in {self.tof_dir}")
+        return read_tof_cube(cube_files[0])
 
     def run(self, 
             config_or_file: Optional[str | Config] = None, 
@@ -544,16 +971,26 @@ class Simulate:
         temp_macro = None
         macro_file = None
         num_events = None
+        expected_runs = 1
         progress_interval = None
         csv_filename = "sim_data.csv"
+        options = []
         
         if isinstance(config_or_file, Config):
             temp_macro = self.sim_dir / "macro.mac"
             macro_file = config_or_file.write(str(temp_macro))
             num_events = config_or_file.num_events
+            if config_or_file.tomo_angles is not None:
+                worker_index, worker_count = config_or_file.tomo_worker
+                expected_runs = len(range(worker_index, int(config_or_file.tomo_angles[2]), worker_count))
             progress_interval = config_or_file.progress_interval
             csv_filename = config_or_file.csv_filename
+            if config_or_file.neutron_plane:
+                options.append("--neutron-plane")
             shutil.copy(str(temp_macro), str(self.archive / "macro.mac"))
+            if config_or_file.notify_file:
+                # lumacam appends, so drop notices from earlier simulations
+                Path(config_or_file.notify_file).unlink(missing_ok=True)
         elif isinstance(config_or_file, str):
             if not os.path.exists(config_or_file):
                 raise FileNotFoundError(f"Macro file not found at {config_or_file}")
@@ -580,7 +1017,7 @@ class Simulate:
 
         try:
             process = subprocess.Popen(
-                [self.lumacam_executable, "macro.mac"],
+                [self.lumacam_executable, *options, "macro.mac"],
                 stdout=subprocess.PIPE,
                 stderr=subprocess.PIPE,
                 text=True,
@@ -595,12 +1032,16 @@ class Simulate:
             output_thread.daemon = True
             output_thread.start()
 
+            # Event IDs restart with every run of a tomography scan
+            events_per_run = num_events
             if num_events is not None:
+                num_events *= expected_runs
                 pbar = tqdm(total=num_events, desc="Simulating", unit="events")
             else:
                 pbar = None
 
             last_event = 0
+            completed_runs = 0
             run_completed = False
             last_update = 0
 
@@ -608,7 +1049,7 @@ class Simulate:
                 try:
                     msg_type, content = output_queue.get(timeout=0.1)
                     if msg_type == 'progress':
-                        current_event = content
+                        current_event = content + completed_runs * (events_per_run or 0)
                         if pbar is not None and progress_interval:
                             if current_event - last_update >= progress_interval:
                                 pbar.n = min(current_event, num_events)
@@ -616,9 +1057,10 @@ class Simulate:
                                 last_update = current_event
                         last_event = current_event
                     elif msg_type == 'complete':
-                        run_completed = True
+                        completed_runs += 1
+                        run_completed = completed_runs >= expected_runs
                         if pbar is not None:
-                            pbar.n = num_events
+                            pbar.n = min(completed_runs * events_per_run, num_events)
                             pbar.refresh()
                     elif msg_type == 'output':
                         if verbosity >= VerbosityLevel.DETAILED:
@@ -671,7 +1113,7 @@ class Simulate:
                             if verbosity >= VerbosityLevel.DETAILED:
                                 print(f"Removed header-only CSV file: {csv_path}")
                         else:
-                            dfs.append(df)
+                            dfs.append(_tag_tomo_angle(df, csv_path))
                             if verbosity >= VerbosityLevel.DETAILED:
                                 print(f"Added {df.shape[0]} rows from {csv_path}")
                     except (pd.errors.EmptyDataError, pd.errors.ParserError) as e:
@@ -685,6 +1127,14 @@ class Simulate:
                 else:
                     print(f"CSV file does not exist: {csv_path}")
             
+            # Binary photon files from /lumacam/photonFormat binary
+            for bin_path in sorted(self.sim_dir.glob(f"{base_name}*.lcph")):
+                df = read_photons_binary(bin_path)
+                if verbosity >= VerbosityLevel.DETAILED:
+                    print(f"Binary photon file {bin_path}: {df.shape[0]} rows")
+                if df.shape[0] > 0:
+                    dfs.append(_tag_tomo_angle(df, bin_path))
+            
             if not dfs:
                 print(f"No valid (non-empty) CSV files found in {self.sim_dir}. Check EventProcessor output logic or simulation configuration.")
                 return pd.DataFrame()  # Return empty DataFrame instead of raising an error
@@ -0,0 +1,51 @@
+import numpy as np
+
+# TPX3 packet constants, shared by Lens._write_tpx3 and Replay
+TICK_NS = 1.5625  # ToA tick
+TOT_TICK_NS = 25.0  # ToT tick
+TDC_TICK_NS = 25.0  # TDC coarse tick
+
+
+def encode_pixels(pixel_x: np.ndarray, pixel_y: np.ndarray, toa_ns: np.ndarray, tot_ns: np.ndarray) -> np.ndarray:
+    """Encode pixel hits as 64-bit TPX3 pixel packets.
+
+    The pixel address is dcol (x/2, 7 bits) | spix (y/4, 6 bits) | pix (x&1, y&3, 3 bits) at
+    bits 59-44, followed by the 14-bit coarse ToA, 10-bit ToT, 4-bit inverted fine ToA and the
+    16-bit SPIDR time, with ToA in 1.5625 ns ticks and ToT in 25 ns ticks (at least one).
+
+    Returns:
+        np.ndarray: uint64 packets, one per hit.
+    """
+    px = np.asarray(pixel_x).astype(np.int64)
+    py = np.asarray(pixel_y).astype(np.int64)
+    toa_ticks = np.round(np.asarray(toa_ns, dtype=float) / TICK_NS).astype(np.int64)
+    tot_ticks = np.clip(np.round(np.maximum(np.asarray(tot_ns, dtype=float), 1.0) / TOT_TICK_NS), 1, 0x3FF)
+
+    pix = ((px & 0x1) << 2) | (py & 0x3)
+    pix_addr = (((px >> 1) & 0x7F) << 9) | (((py >> 2) & 0x3F) << 3) | pix
+    spidr_time = (toa_ticks >> 18) & 0xFFFF
+    coarse_toa = (toa_ticks >> 4) & 0x3FFF
+    ftoa = 15 - (toa_ticks & 0xF)
+    return ((np.uint64(0xB) << np.uint64(60)) | (pix_addr.astype(np.uint64) << np.uint64(44)) |
+            (coarse_toa.astype(np.uint64) << np.uint64(30)) | (tot_ticks.astype(np.uint64) << np.uint64(20)) |
+            (ftoa.astype(np.uint64) << np.uint64(16)) | spidr_time.astype(np.uint64))
+
+
+def encode_tdc(trigger_ns: np.ndarray, trigger_counter: np.ndarray) -> np.ndarray:
+    """Encode triggers as rising-edge TDC1 packets.
+
+    The decoder reads coarsetime = (word >> 12) & 0xFFFFFFFF in 25 ns units, tmpfine =
+    (word >> 5) & 0xF as a clock phase 1-12 and trigtime_fine = (word & 0x0E00) |
+    (((tmpfine - 1) << 9) / 12) in 25/4096 ns units; the trigger counter is 12 bits at bit 44.
+
+    Returns:
+        np.ndarray: uint64 packets, one per trigger.
+    """
+    trigger_ns = np.asarray(trigger_ns, dtype=float)
+    coarse = np.floor(trigger_ns / TDC_TICK_NS).astype(np.int64) & 0xFFFFFFFF
+    fine = np.round((trigger_ns - coarse * TDC_TICK_NS) * 4096.0 / TDC_TICK_NS).astype(np.int64) & 0xFFF
+    tmpfine = np.clip(np.round((fine & 0x1FF) * 12.0 / 512.0 + 1.0), 1, 12).astype(np.int64)
+    counter = np.asarray(trigger_counter).astype(np.int64) & 0xFFF
+    return ((np.uint64(0x6F) << np.uint64(56)) | (counter.astype(np.uint64) << np.uint64(44)) |
+            (coarse.astype(np.uint64) << np.uint64(12)) | (((fine >> 9) & 0x7).astype(np.uint64) << np.uint64(9)) |
+            (tmpfine.astype(np.uint64) << np.uint64(5)))
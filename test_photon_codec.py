@@ -0,0 +1,197 @@
+#!/usr/bin/env python3
+"""
+Round-trip test for the binary photon codec.
+test_data/photon_codec.lcph was written by PhotonCodec (CODEC_BLOCK_PHOTONS 50, default grid and
+tick, weighted) through src/G4LumaCam/PhotonCodecFixture.cc, from the photons that
+expected_photons() rebuilds. This script checks:
+1. Every decoded value is within its quantization bound of the original
+2. The block index statistics match the photons of each block
+3. The native and Python decoders agree, and the native one rejects blocks whose photon
+   count disagrees with the index
+4. The current PhotonCodec still writes the fixture byte for byte, when
+   LUMACAM_CODEC_FIXTURE points to a built lumacam-codec-fixture
+"""
+
+import sys
+sys.path.insert(0, 'src')
+
+import os
+import subprocess
+import tempfile
+from pathlib import Path
+
+import numpy as np
+import pandas as pd
+from lumacam.reader import PhotonReader, read_block_index, INDEX_ENTRY, TRAILER
+
+FIXTURE = Path(__file__).parent / "test_data" / "photon_codec.lcph"
+BLOCK_PHOTONS = 50
+GRID = 1e-3  # mm
+TICK = 1e-3  # ns
+WAVELENGTH_STEP = 0.01  # nm
+EPSILON = 1e-9  # Rounding of values that sit exactly on a half step
+
+def expected_photons():
+    """The photons the fixture was written from, in file order (see PhotonCodecFixture.cc)."""
+    rows = []
+    for ev in range(40):
+        pulse = ev // 4
+        for i in range(5 + ev % 7):
+            px, py, pz = 10 * np.sin(0.7 * ev), 10 * np.cos(0.3 * ev), 0.1 * ev + 0.01 * (i % 2)
+            theta, phi = 0.2 + 0.13 * i + 0.07 * ev, 0.5 * i + 0.3 * ev
+            pulse_time = pulse * 1.0e5
+            rows.append({
+                "id": 1 + 3 * i, "parent_id": 2 + i % 2, "neutron_id": ev, "pulse_id": pulse,
+                "pulse_time_ns": pulse_time,
+                "x": px + 0.37 * np.sin(1.3 * i + ev), "y": py + 0.41 * np.cos(0.9 * i - ev),
+                "z": pz + 0.0123456 * i,
+                "dx": np.sin(theta) * np.cos(phi), "dy": np.sin(theta) * np.sin(phi), "dz": np.cos(theta),
+                "toa": pulse_time + 40 + 0.1234567 * i + 0.0017 * ev,
+                "wavelength": 380 + 0.737 * i + 0.1 * ev,
+                "parentName": "proton" if i % 2 else "e-", "px": px, "py": py, "pz": pz,
+                "parentEnergy": 0.5 + 0.01 * ev,
+                "nx": 0.5 * np.sin(ev), "ny": 0.5 * np.cos(ev), "nz": -0.25,
+                "neutronEnergy": 1e-6 * (ev + 1), "weight": 0.5 + 0.01 * i,
+            })
+    return pd.DataFrame(rows)
+
+def test_quantization_bounds():
+    """Test that decoded values stay within the quantization bounds."""
+    print("Testing quantization bounds...")
+    expected = expected_photons()
+    decoded = PhotonReader(FIXTURE, native=False).read()
+    assert len(decoded) == len(expected), f"Expected {len(expected)} photons, got {len(decoded)}"
+
+    for column in ["id", "parent_id", "neutron_id", "pulse_id", "parentName"]:
+        assert (decoded[column].to_numpy() == expected[column].to_numpy()).all(), f"{column} differs"
+    print("  ✓ IDs and parent types exact")
+
+    bounds = {"x": GRID / 2, "y": GRID / 2, "z": GRID / 2, "px": GRID / 2, "py": GRID / 2, "pz": GRID / 2,
+              "nx": GRID / 2, "ny": GRID / 2, "nz": GRID / 2, "toa": TICK / 2, "pulse_time_ns": TICK / 2,
+              "wavelength": WAVELENGTH_STEP / 2}
+    for column, bound in bounds.items():
+        error = np.abs(decoded[column].to_numpy() - expected[column].to_numpy()).max()
+        assert error <= bound + EPSILON, f"{column} error {error} exceeds {bound}"
+        print(f"  ✓ {column}: max error {error:.3g} (bound {bound:.3g})")
+
+    # Octahedral int16 directions resolve to well under a milliradian
+    cos_angle = (decoded[["dx", "dy", "dz"]].to_numpy() * expected[["dx", "dy", "dz"]].to_numpy()).sum(axis=1)
+    angle = np.arccos(np.clip(cos_angle, -1, 1)).max()
+    assert angle < 1e-4, f"Direction error {angle} rad"
+    print(f"  ✓ direction: max error {angle * 1e3:.3g} mrad")
+
+    for column in ["parentEnergy", "neutronEnergy", "weight"]:
+        assert (decoded[column].to_numpy() == expected[column].to_numpy().astype(np.float32)).all(), f"{column} differs"
+    print("  ✓ float32 columns exact")
+
+    print("✓ All values within quantization bounds\n")
+
+def test_block_stats():
+    """Test that the footer index describes the photons of each block."""
+    print("Testing block statistics...")
+    expected = expected_photons()
+    index = read_block_index(FIXTURE)
+
+    # Whole events fill a block until it reaches BLOCK_PHOTONS
+    block_of, block, photons = {}, 0, 0
+    for neutron_id, count in expected.groupby("neutron_id", sort=False).size().items():
+        block_of[neutron_id] = block
+        photons += count
+        if photons >= BLOCK_PHOTONS:
+            block, photons = block + 1, 0
+    expected["block"] = expected["neutron_id"].map(block_of)
+    assert len(index) == expected["block"].nunique(), f"Expected {expected['block'].nunique()} blocks, got {len(index)}"
+
+    offset = None
+    for b, rows in expected.groupby("block"):
+        stats = index.iloc[b]
+        assert offset is None or stats["offset"] > offset, "Blocks out of file order"
+        offset = stats["offset"]
+        assert stats["events"] == rows["neutron_id"].nunique()
+        assert stats["photons"] == len(rows)
+        assert (stats["neutron_id_min"], stats["neutron_id_max"]) == (rows["neutron_id"].min(), rows["neutron_id"].max())
+        assert (stats["pulse_id_min"], stats["pulse_id_max"]) == (rows["pulse_id"].min(), rows["pulse_id"].max())
+        for key, column, bound in (("toa", "toa", TICK / 2), ("x", "x", GRID / 2), ("y", "y", GRID / 2)):
+            assert abs(stats[f"{key}_min"] - rows[column].min()) <= bound + EPSILON, f"Block {b} {key}_min"
+            assert abs(stats[f"{key}_max"] - rows[column].max()) <= bound + EPSILON, f"Block {b} {key}_max"
+        assert stats["neutron_energy_min"] == np.float32(rows["neutronEnergy"].min())
+        assert stats["neutron_energy_max"] == np.float32(rows["neutronEnergy"].max())
+        print(f"  ✓ block {b}: {int(stats['events'])} events, {int(stats['photons'])} photons")
+
+    print("✓ Block statistics match\n")
+
+def test_native_reader():
+    """Test that liblumacam_reader decodes the same rows, when it is installed."""
+    print("Testing native reader...")
+    native = PhotonReader(FIXTURE)
+    if native.library is None:
+        print("  - liblumacam_reader not found, skipped\n")
+        return
+    pd.testing.assert_frame_equal(native.read(), PhotonReader(FIXTURE, native=False).read(), check_dtype=False)
+    print("✓ Native and Python decoders agree\n")
+
+def test_native_block_count():
+    """Test that the native reader refuses a block whose index photon count is off by one either way."""
+    print("Testing native block photon count check...")
+    if PhotonReader(FIXTURE).library is None:
+        print("  - liblumacam_reader not found, skipped\n")
+        return
+    data = bytearray(FIXTURE.read_bytes())
+    index_offset = TRAILER.unpack_from(data, len(data) - TRAILER.size)[1]
+    photons_at = index_offset + INDEX_ENTRY.size + 16  # Second entry: offset, bytes, events, photons
+    photons = int.from_bytes(data[photons_at:photons_at + 4], "little")
+    with tempfile.TemporaryDirectory() as tmp:
+        for count in (photons - 1, photons + 1):
+            corrupt = Path(tmp) / "corrupt.lcph"
+            data[photons_at:photons_at + 4] = count.to_bytes(4, "little")
+            corrupt.write_bytes(data)
+            try:
+                PhotonReader(corrupt).read()
+            except ValueError as e:
+                print(f"  ✓ {count} for {photons} photons: {e}")
+            else:
+                raise AssertionError(f"Index count {count} for {photons} photons was accepted")
+    print("✓ Mismatched block photon counts are rejected\n")
+
+def test_writer():
+    """Test that the current PhotonCodec writes the committed fixture, when the generator is built."""
+    print("Testing PhotonCodec writer...")
+    generator = os.environ.get("LUMACAM_CODEC_FIXTURE")
+    if not generator:
+        print("  - LUMACAM_CODEC_FIXTURE not set, skipped\n")
+        return
+    with tempfile.TemporaryDirectory() as tmp:
+        output = Path(tmp) / "photon_codec.lcph"
+        subprocess.run([generator, str(output)], check=True, capture_output=True)
+        assert output.read_bytes() == FIXTURE.read_bytes(), \
+            "Writer output differs from the fixture; regenerate it if the format changed on purpose"
+    print("✓ Writer reproduces the fixture\n")
+
+def main():
+    """Run all tests."""
+    print("=" * 60)
+    print("Photon Codec Round-Trip Tests")
+    print("=" * 60 + "\n")
+
+    try:
+        test_quantization_bounds()
+        test_block_stats()
+        test_native_reader()
+        test_native_block_count()
+        test_writer()
+
+        print("=" * 60)
+        print("ALL TESTS PASSED ✓")
+        print("=" * 60)
+        return 0
+    except Exception as e:
+        print("\n" + "=" * 60)
+        print("TEST FAILED ✗")
+        print("=" * 60)
+        print(f"Error: {e}")
+        import traceback
+        traceback.print_exc()
+        return 1
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""
+Query tests for PhotonReader on test_data/photon_codec.lcph (see test_photon_codec.py).
+This script checks that:
+1. Range queries return exactly the rows a full read filtered in pandas would
+2. Column projection keeps the requested columns and rows
+3. The native (liblumacam_reader) and Python decoders agree on every query
+4. Range queries skip the blocks their index statistics exclude
+"""
+
+import sys
+sys.path.insert(0, 'src')
+
+from pathlib import Path
+
+import numpy as np
+import pandas as pd
+from lumacam import reader
+from lumacam.reader import PhotonReader, read_block_index
+
+FIXTURE = Path(__file__).parent / "test_data" / "photon_codec.lcph"
+
+QUERIES = {
+    "neutron_id": {"neutron_id": (8, 20)},
+    "pulse_id": {"pulse_id": (3, None)},
+    "toa": {"toa": (None, 400050.0)},
+    "neutron_energy": {"neutron_energy": (5e-6, 1.2e-5)},
+    "roi": {"x": (-5.0, 5.0), "y": (0.0, None)},
+    "combined": {"pulse_id": (2, 8), "x": (None, 0.0), "toa": (200000.0, None)},
+    "empty": {"neutron_id": (1000, None)},
+}
+PROJECTION = ["x", "y", "toa", "neutron_id"]
+
+def expected_rows(full, query):
+    """Rows of a full read inside the inclusive query ranges."""
+    mask = np.ones(len(full), dtype=bool)
+    for key, (low, high) in query.items():
+        column = reader.PREDICATES[key]
+        if low is not None:
+            mask &= (full[column] >= low).to_numpy()
+        if high is not None:
+            mask &= (full[column] <= high).to_numpy()
+    return full[mask].reset_index(drop=True)
+
+def test_python_queries():
+    """Test the Python decoder against pandas filtering of a full read."""
+    print("Testing Python decoder queries...")
+    full = PhotonReader(FIXTURE, native=False).read()
+
+    for name, query in QUERIES.items():
+        result = PhotonReader(FIXTURE, native=False, **query).read()
+        expected = expected_rows(full, query)
+        pd.testing.assert_frame_equal(result, expected, check_dtype=False)
+
+        projected = PhotonReader(FIXTURE, columns=PROJECTION, native=False, **query).read()
+        assert list(projected.columns) == PROJECTION, f"{name}: columns {list(projected.columns)}"
+        pd.testing.assert_frame_equal(projected, expected[PROJECTION], check_dtype=False)
+        print(f"  ✓ {name}: {len(result)} rows")
+
+    chunks = list(PhotonReader(FIXTURE, native=False).iter_chunks(100))
+    assert len(chunks) > 1, "Expected several chunks"
+    pd.testing.assert_frame_equal(pd.concat(chunks, ignore_index=True), full)
+    print(f"  ✓ iter_chunks: {len(chunks)} chunks")
+
+    print("✓ Python queries match\n")
+
+def test_native_matches_python():
+    """Test that the native and Python decoders return the same rows and columns."""
+    print("Testing native reader against the Python decoder...")
+    if PhotonReader(FIXTURE).library is None:
+        print("  - liblumacam_reader not found, skipped\n")
+        return
+
+    for name, query in QUERIES.items():
+        for columns in (None, PROJECTION):
+            native = PhotonReader(FIXTURE, columns=columns, **query).read()
+            python = PhotonReader(FIXTURE, columns=columns, native=False, **query).read()
+            pd.testing.assert_frame_equal(native, python, check_dtype=False)
+        print(f"  ✓ {name}: {len(native)} rows")
+
+    print("✓ Native and Python decoders agree\n")
+
+def test_block_skipping():
+    """Test that the Python decoder only reads the blocks a query can match."""
+    print("Testing block skipping...")
+    index = read_block_index(FIXTURE)
+    decoded = []
+    original = reader._decode_block
+
+    def counting_decode(data, pos, end, *args):
+        decoded.append(end - pos)
+        return original(data, pos, end, *args)
+
+    reader._decode_block = counting_decode
+    try:
+        for name, query in QUERIES.items():
+            decoded.clear()
+            PhotonReader(FIXTURE, native=False, **query).read()
+            keep = index["photons"] > 0
+            # Index columns are named after the query keywords
+            for key, (low, high) in query.items():
+                if low is not None:
+                    keep &= index[f"{key}_max"] >= low
+                if high is not None:
+                    keep &= index[f"{key}_min"] <= high
+            assert sorted(decoded) == sorted(index["bytes"][keep].astype(int)), f"{name}: decoded {decoded}"
+            print(f"  ✓ {name}: {len(decoded)} of {len(index)} blocks read")
+    finally:
+        reader._decode_block = original
+
+    print("✓ Only overlapping blocks are read\n")
+
+def main():
+    """Run all tests."""
+    print("=" * 60)
+    print("Photon Reader Query Tests")
+    print("=" * 60 + "\n")
+
+    try:
+        test_python_queries()
+        test_native_matches_python()
+        test_block_skipping()
+
+        print("=" * 60)
+        print("ALL TESTS PASSED ✓")
+        print("=" * 60)
+        return 0
+    except Exception as e:
+        print("\n" + "=" * 60)
+        print("TEST FAILED ✗")
+        print("=" * 60)
+        print(f"Error: {e}")
+        import traceback
+        traceback.print_exc()
+        return 1
+
+if __name__ == "__main__":
+    sys.exit(main())
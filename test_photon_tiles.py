@@ -0,0 +1,215 @@
+#!/usr/bin/env python3
+"""
+Region-of-interest test for tiled binary photon files.
+test_data/photon_codec_tiled.lcph holds the photons of test_photon_codec.py written with
+CODEC_TILE_SIZE 5 mm and CODEC_BLOCK_PHOTONS 10 (lumacam-codec-fixture <output> 5). This script checks:
+1. The blocks are the ones PhotonCodec's tiling writes: a fragment per tile and event, blocks
+   closed when full, the fullest tile written early past kMaxPendingBlocks blocks of pending
+   photons, and the rest on Close
+2. The x/y bounds of every block in the footer index lie within its tile
+3. An ROI read skips the blocks of other tiles and returns the photons inside the ROI, through
+   both the Python and the native decoder
+4. The current PhotonCodec still writes the fixture byte for byte, when
+   LUMACAM_CODEC_FIXTURE points to a built lumacam-codec-fixture
+"""
+
+import sys
+sys.path.insert(0, 'src')
+
+import ctypes
+import math
+import os
+import subprocess
+import tempfile
+from pathlib import Path
+
+import numpy as np
+import pandas as pd
+import lumacam.reader
+from lumacam.reader import PhotonReader, read_block_index
+from test_photon_codec import expected_photons, GRID
+
+FIXTURE = Path(__file__).parent / "test_data" / "photon_codec_tiled.lcph"
+TILE = 5.0  # mm
+BLOCK_PHOTONS = 10
+MAX_PENDING_BLOCKS = 8  # kMaxPendingBlocks in PhotonCodec.cc
+ROI = {"x": (1.0, 4.0), "y": (-9.5, -6.5)}  # Inside tile (0, -2)
+
+def tile_of(x, y):
+    return math.floor(x / TILE), math.floor(y / TILE)
+
+def expected_blocks():
+    """Replay PhotonCodec::WriteEvent on expected_photons(): (tile, neutron_ids, photons, cause) per block."""
+    photons = expected_photons()
+    pending = {}  # Tile -> [neutron_ids, photons]; std::map iterates in sorted key order
+    pending_photons = 0
+    blocks = []
+
+    def flush(tile, cause):
+        ids, count = pending[tile]
+        if ids:
+            blocks.append((tile, ids, count, cause))
+        pending[tile] = [[], 0]
+        return count
+
+    for neutron_id, event in photons.groupby("neutron_id", sort=False):
+        fragments = {}
+        for x, y in zip(event["x"], event["y"]):
+            tile = tile_of(x, y)
+            fragments[tile] = fragments.get(tile, 0) + 1
+        for tile in sorted(fragments):
+            ids, count = pending.setdefault(tile, [[], 0])
+            pending[tile] = [ids + [neutron_id], count + fragments[tile]]
+            pending_photons += fragments[tile]
+            if pending[tile][1] >= BLOCK_PHOTONS:
+                pending_photons -= flush(tile, "full")
+        while pending_photons > MAX_PENDING_BLOCKS * BLOCK_PHOTONS:
+            fullest = max(sorted(pending), key=lambda t: pending[t][1])  # First of the largest, like max_element
+            pending_photons -= flush(fullest, "cap")
+            del pending[fullest]
+    for tile in sorted(pending):
+        flush(tile, "close")
+    return blocks
+
+def test_tile_blocks():
+    """Test that the file holds the blocks the tiling writes, in order."""
+    print("Testing tiled block layout...")
+    blocks = expected_blocks()
+    index = read_block_index(FIXTURE)
+    assert len(index) == len(blocks), f"{len(index)} blocks, expected {len(blocks)}"
+    for b, (tile, ids, count, cause) in enumerate(blocks):
+        row = index.iloc[b]
+        assert (row["events"], row["photons"]) == (len(ids), count), \
+            f"Block {b}: {row['events']} events, {row['photons']} photons, expected {len(ids)}, {count}"
+        assert (row["neutron_id_min"], row["neutron_id_max"]) == (min(ids), max(ids)), f"Block {b}: neutron_id range"
+    causes = [cause for _, _, _, cause in blocks]
+    for cause in ("full", "cap", "close"):
+        print(f"  ✓ {causes.count(cause)} blocks written {cause}")
+        assert cause in causes, f"No block written {cause}"
+    print(f"✓ {len(blocks)} blocks match the writer's tiling\n")
+
+def test_tile_bounds():
+    """Test that the footer index bounds every block within its tile."""
+    print("Testing tile bounds in the footer index...")
+    index = read_block_index(FIXTURE)
+    for b, (tile, _, _, _) in enumerate(expected_blocks()):
+        row = index.iloc[b]
+        # Photons are tiled on the exact position and bounded on the quantized one
+        for low, high, t in ((row["x_min"], row["x_max"], tile[0]), (row["y_min"], row["y_max"], tile[1])):
+            assert t * TILE - GRID / 2 <= low <= high <= (t + 1) * TILE + GRID / 2, \
+                f"Block {b}: [{low}, {high}] outside tile {t}"
+    print(f"✓ All {len(index)} blocks lie within their tiles\n")
+
+def roi_photons():
+    """The expected photons inside ROI, in file order of the ROI's single tile."""
+    photons = expected_photons()
+    inside = np.ones(len(photons), dtype=bool)
+    for column, (low, high) in ROI.items():
+        inside &= ((photons[column] >= low) & (photons[column] <= high)).to_numpy()
+    return photons[inside].reset_index(drop=True)
+
+def check_roi_rows(df, expected):
+    assert len(df) == len(expected), f"{len(df)} rows, expected {len(expected)}"
+    got = df.sort_values(["neutron_id", "id"]).reset_index(drop=True)
+    want = expected.sort_values(["neutron_id", "id"]).reset_index(drop=True)
+    for column in ("neutron_id", "id"):
+        assert (got[column].to_numpy() == want[column].to_numpy()).all(), f"{column} differs"
+    for column in ("x", "y"):
+        error = np.abs(got[column].to_numpy() - want[column].to_numpy()).max()
+        assert error <= GRID / 2 + 1e-9, f"{column} error {error}"
+
+def test_roi_python():
+    """Test that the Python decoder only decodes overlapping blocks and returns the ROI photons."""
+    print("Testing ROI read (Python)...")
+    index = read_block_index(FIXTURE)
+    overlapping = ((index["x_max"] >= ROI["x"][0]) & (index["x_min"] <= ROI["x"][1]) &
+                   (index["y_max"] >= ROI["y"][0]) & (index["y_min"] <= ROI["y"][1])).sum()
+    assert 0 < overlapping < len(index), f"{overlapping} of {len(index)} blocks overlap the ROI"
+
+    decoded = []
+    decode_block = lumacam.reader._decode_block
+    def counting(data, *args):
+        decoded.append(len(data))
+        return decode_block(data, *args)
+    lumacam.reader._decode_block = counting
+    try:
+        df = PhotonReader(FIXTURE, native=False, **ROI).read()
+    finally:
+        lumacam.reader._decode_block = decode_block
+    assert len(decoded) == overlapping, f"Decoded {len(decoded)} blocks, {overlapping} overlap the ROI"
+    check_roi_rows(df, roi_photons())
+    print(f"  ✓ Decoded {len(decoded)} of {len(index)} blocks")
+    print(f"✓ {len(df)} ROI photons match\n")
+
+def test_roi_native():
+    """Test that the native reader plans only overlapping blocks and agrees with the Python decoder."""
+    print("Testing ROI read (native)...")
+    reader = PhotonReader(FIXTURE, **ROI)
+    lib = reader.library
+    if lib is None:
+        print("  - liblumacam_reader not found, skipped\n")
+        return
+    index = read_block_index(FIXTURE)
+    overlapping = ((index["x_max"] >= ROI["x"][0]) & (index["x_min"] <= ROI["x"][1]) &
+                   (index["y_max"] >= ROI["y"][0]) & (index["y_min"] <= ROI["y"][1]))
+
+    error = ctypes.create_string_buffer(512)
+    handle = lib.lcph_open(str(FIXTURE).encode(), error, len(error))
+    assert handle, error.value.decode()
+    try:
+        last = ctypes.c_size_t()
+        capacity = lib.lcph_plan(handle, ctypes.byref(reader._query()), 0, 2**63 - 1, ctypes.byref(last))
+    finally:
+        lib.lcph_close(handle)
+    assert capacity == index["photons"][overlapping].sum(), \
+        f"Planned {capacity} rows, {index['photons'][overlapping].sum()} photons in overlapping blocks"
+    assert capacity < index["photons"].sum()
+
+    df = reader.read()
+    check_roi_rows(df, roi_photons())
+    pd.testing.assert_frame_equal(df, PhotonReader(FIXTURE, native=False, **ROI).read(), check_dtype=False)
+    print(f"  ✓ Planned {capacity} of {index['photons'].sum()} photons")
+    print("✓ Native and Python ROI reads agree\n")
+
+def test_writer():
+    """Test that the current PhotonCodec writes the committed tiled fixture, when the generator is built."""
+    print("Testing tiled PhotonCodec writer...")
+    generator = os.environ.get("LUMACAM_CODEC_FIXTURE")
+    if not generator:
+        print("  - LUMACAM_CODEC_FIXTURE not set, skipped\n")
+        return
+    with tempfile.TemporaryDirectory() as tmp:
+        output = Path(tmp) / "photon_codec_tiled.lcph"
+        subprocess.run([generator, str(output), str(TILE)], check=True, capture_output=True)
+        assert output.read_bytes() == FIXTURE.read_bytes(), \
+            "Writer output differs from the fixture; regenerate it if the format changed on purpose"
+    print("✓ Writer reproduces the tiled fixture\n")
+
+def main():
+    """Run all tests."""
+    print("=" * 60)
+    print("Tiled Photon File ROI Tests")
+    print("=" * 60 + "\n")
+
+    try:
+        test_tile_blocks()
+        test_tile_bounds()
+        test_roi_python()
+        test_roi_native()
+        test_writer()
+
+        print("=" * 60)
+        print("ALL TESTS PASSED ✓")
+        print("=" * 60)
+        return 0
+    except Exception as e:
+        print("\n" + "=" * 60)
+        print("TEST FAILED ✗")
+        print("=" * 60)
+        print(f"Error: {e}")
+        import traceback
+        traceback.print_exc()
+        return 1
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,177 @@
+#!/usr/bin/env python3
+"""
+Validation test for re-timing finished output sets.
+This script checks that:
+1. PulseSchedule assigns neutrons to the triggers Sim::ComputePulseStructure gives them,
+   at low (< 1 neutron per pulse) and high rates
+2. Retimer writes every photon once, keeps its delay behind the new trigger, and writes
+   globally time-ordered files while holding back only what the watermark requires
+"""
+
+import sys
+sys.path.insert(0, 'src')
+
+import math
+import shutil
+import tempfile
+from pathlib import Path
+
+import numpy as np
+import pandas as pd
+from lumacam.reader import COLUMNS
+from lumacam.retime import PulseSchedule, Retimer
+
+def compute_pulse_structure(flux, freq, total_neutrons, uniforms, scint_size=12.0):
+    """Port of Sim::ComputePulseStructure (SimConfig.cc) with its G4UniformRand draws given.
+
+    Returns:
+        Tuple[list, list]: pulseTimes (ns) and neutronsPerPulse, as the simulator fills them.
+    """
+    fov_area = scint_size * scint_size
+    pulse_period = 1.0 / freq
+    avg = flux * fov_area / freq
+    num_pulses = math.ceil(total_neutrons / avg)
+    pulse_times, neutrons_per_pulse = [], []
+    if avg < 1.0:
+        pulses_per_neutron = 1.0 / avg
+        for n in range(total_neutrons):
+            pulse_times.append(math.floor(n * pulses_per_neutron) * pulse_period * 1e9)
+            neutrons_per_pulse.append(1)
+    else:
+        remaining = total_neutrons
+        for i in range(num_pulses):
+            if remaining <= 0:
+                break
+            count = min(math.floor(avg + uniforms[i]), remaining)
+            neutrons_per_pulse.append(count)
+            pulse_times.append(i * pulse_period * 1e9)
+            remaining -= count
+    return pulse_times, neutrons_per_pulse
+
+def simulator_triggers(pulse_times, neutrons_per_pulse):
+    """Trigger time of each generated neutron, as ParticleGenerator hands out the pulses."""
+    return np.repeat(pulse_times, neutrons_per_pulse)
+
+def test_low_rate_schedule():
+    """Test the schedule below one neutron per pulse."""
+    print("Testing low-rate pulse schedule...")
+    for flux, freq in ((1e3, 1e6), (2e3, 3e5), (0.3, 60.0)):
+        schedule = PulseSchedule(flux, freq)
+        assert schedule.mean < 1.0
+        pulse_times, counts = compute_pulse_structure(flux, freq, 5000, None)
+        events = np.arange(5000)
+        triggers = schedule.pulse_times(schedule.pulse_ids(events))
+        assert np.array_equal(triggers, simulator_triggers(pulse_times, counts)), f"flux {flux}, freq {freq}"
+        # The simulator numbers one pulse entry per neutron; the schedule numbers triggers
+        assert np.allclose(schedule.pulse_ids(events) * 1e9 / freq, triggers)
+        print(f"  ✓ flux {flux:g}, freq {freq:g}: {schedule.mean:.4f} neutrons/pulse")
+    print("✓ Low-rate triggers match Sim::ComputePulseStructure\n")
+
+def test_high_rate_schedule():
+    """Test the schedule at one or more neutrons per pulse, with the simulator's draws."""
+    print("Testing high-rate pulse schedule...")
+    for flux, freq, seed in ((1e2, 1e3, 1), (8.0, 1e3, 2), (1e4, 144.0, 3)):
+        schedule = PulseSchedule(flux, freq, seed=seed)
+        assert schedule.mean >= 1.0
+        total = 20000
+        # Both draw u in [0, 1) per pulse in order from the same stream
+        uniforms = np.random.default_rng(seed).random(math.ceil(total / schedule.mean) + 1024)
+        pulse_times, counts = compute_pulse_structure(flux, freq, total, uniforms)
+        assert sum(counts) == total
+
+        events = np.arange(total)
+        pulse_ids = schedule.pulse_ids(events)
+        expected = simulator_triggers(pulse_times, counts)
+        assert np.array_equal(schedule.pulse_times(pulse_ids), expected), f"flux {flux}, freq {freq}"
+        assert np.array_equal(pulse_ids, np.repeat(np.arange(len(counts)), counts))
+
+        # Lazily extended schedules give the same answer when queried out of order
+        again = PulseSchedule(flux, freq, seed=seed)
+        shuffled = np.random.default_rng(0).permutation(events)
+        assert np.array_equal(again.pulse_ids(shuffled), pulse_ids[shuffled])
+        print(f"  ✓ flux {flux:g}, freq {freq:g}: {schedule.mean:.2f} neutrons/pulse, {len(counts)} pulses")
+    print("✓ High-rate triggers match Sim::ComputePulseStructure\n")
+
+def write_archive(directory, neutrons, period_ns, seed=0):
+    """SimPhotons CSV batches with photons trailing their neutron's trigger by up to 2.5 periods."""
+    rng = np.random.default_rng(seed)
+    photon_dir = directory / "SimPhotons"
+    photon_dir.mkdir(parents=True)
+    rows = []
+    for n in range(neutrons):
+        count = int(rng.integers(1, 6))
+        delays = np.sort(rng.exponential(0.4 * period_ns, count).clip(max=2.5 * period_ns))
+        for i, delay in enumerate(delays):
+            row = {c: 0.0 for c in COLUMNS[:-1]}
+            row.update({"id": i + 1, "parent_id": 1, "neutron_id": n, "pulse_id": n,
+                        "pulse_time_ns": n * period_ns, "toa": n * period_ns + delay, "parentName": "proton"})
+            rows.append(row)
+    df = pd.DataFrame(rows, columns=COLUMNS[:-1])
+    # Batches split at neutron boundaries, named so that only a numeric sort keeps their order
+    bounds = np.searchsorted(df["neutron_id"].to_numpy(), [0, neutrons // 3, 2 * neutrons // 3, neutrons])
+    for index, (start, end) in enumerate(zip(bounds[:-1], bounds[1:])):
+        df.iloc[start:end].to_csv(photon_dir / f"sim_data_{[2, 10, 11][index]}.csv", index=False)
+    return df
+
+def test_retimer_watermark():
+    """Test that re-timed output is complete, time-ordered and released behind the watermark."""
+    print("Testing Retimer time ordering...")
+    root = Path(tempfile.mkdtemp())
+    try:
+        source = write_archive(root / "source", neutrons=600, period_ns=1e5)
+        flux, freq = 2e4, 1e4  # About 288 neutrons per pulse, delays up to 2.5 of the new periods
+        report = Retimer(str(root / "source"), flux, freq, seed=5).run(str(root / "out"), chunk_rows=200,
+                                                                         rows_per_file=500, verbose=False)
+        files = sorted((root / "out" / "SimPhotons").glob("retimed_*.csv"), key=lambda p: int(p.stem.split("_")[1]))
+        out = pd.concat([pd.read_csv(f) for f in files], ignore_index=True)
+
+        assert len(out) == len(source) == report.photons
+        assert report.files == len(files) and all(len(pd.read_csv(f)) <= 500 for f in files)
+        assert np.all(np.diff(out["toa"].to_numpy()) >= 0), "Output is not time-ordered"
+        print(f"  ✓ {len(out)} photons in {len(files)} time-ordered files")
+
+        # Each photon keeps its delay; its neutron moves to the scheduled trigger
+        key = ["neutron_id", "id"]
+        merged = out.merge(source, on=key, suffixes=("", "_source"))
+        assert len(merged) == len(source)
+        delay = merged["toa"] - merged["pulse_time_ns"]
+        assert np.allclose(delay, merged["toa_source"] - merged["pulse_time_ns_source"])
+        schedule = PulseSchedule(flux, freq, seed=5)
+        assert np.array_equal(merged["pulse_id"], schedule.pulse_ids(merged["neutron_id"].to_numpy()))
+        assert np.allclose(merged["pulse_time_ns"], merged["pulse_id"] * 1e9 / freq)
+        print("  ✓ delays behind the trigger preserved")
+
+        # Only photons that may still be preceded by later neutrons are held back
+        assert report.max_buffered < len(source), f"Buffered {report.max_buffered} of {len(source)}"
+        assert report.neutrons == 600 and report.pulses == schedule.pulse_ids(np.array([599]))[0] + 1
+        print(f"  ✓ peak buffer {report.max_buffered} of {len(source)} photons")
+    finally:
+        shutil.rmtree(root)
+    print("✓ Retimer output is complete and time-ordered\n")
+
+def main():
+    """Run all tests."""
+    print("=" * 60)
+    print("Retime Tests")
+    print("=" * 60 + "\n")
+
+    try:
+        test_low_rate_schedule()
+        test_high_rate_schedule()
+        test_retimer_watermark()
+
+        print("=" * 60)
+        print("ALL TESTS PASSED ✓")
+        print("=" * 60)
+        return 0
+    except Exception as e:
+        print("\n" + "=" * 60)
+        print("TEST FAILED ✗")
+        print("=" * 60)
+        print(f"Error: {e}")
+        import traceback
+        traceback.print_exc()
+        return 1
+
+if __name__ == "__main__":
+    sys.exit(main())
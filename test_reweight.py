@@ -0,0 +1,154 @@
+#!/usr/bin/env python3
+"""
+Validation test for SpectrumReweighter.
+This script checks that:
+1. Reweighting a Lin sample to a known target gives the analytic weights, unit mean weight,
+   the target's mean energy and the expected effective sample size
+2. Lin spectra are evaluated in their configured energy unit
+3. Hist spectra follow the GPS convention that the first point only sets the lower edge
+4. diagnostics, apply and write_table report and write the same weights
+"""
+
+import sys
+sys.path.insert(0, 'src')
+
+import tempfile
+from pathlib import Path
+
+import numpy as np
+import pandas as pd
+from lumacam.simulate import Config
+from lumacam.reweight import SpectrumReweighter
+
+N_NEUTRONS = 200000
+
+def lin_config(emin, emax, gradient, intercept, unit="MeV"):
+    return Config(energy_type="Lin", energy_min=emin, energy_max=emax, energy_gradient=gradient,
+                  energy_intercept=intercept, energy_unit=unit)
+
+def test_lin_to_known_target():
+    """Test reweighting a flat Lin sample on 1-10 MeV to a density proportional to E."""
+    print("Testing Lin sample reweighted to a linear target...")
+    reweighter = SpectrumReweighter(target=lambda e: e, sampling=lin_config(1.0, 10.0, 0.0, 1.0))
+
+    # Normalized: sampling 1/9, target E/49.5, so w(E) = 9E/49.5
+    energies = np.array([1.0, 2.5, 5.0, 10.0])
+    assert np.allclose(reweighter.weight(energies), 9 * energies / 49.5, rtol=1e-6)
+    assert np.all(reweighter.weight(np.array([0.5, 10.5])) == 0)
+    assert abs(reweighter.coverage - 1.0) < 1e-9
+    print("  ✓ weights match 9E/49.5, zero outside the sampling range")
+
+    sample = np.random.default_rng(7).uniform(1.0, 10.0, N_NEUTRONS)
+    weights = reweighter.weight(sample)
+    assert abs(weights.mean() - 1.0) < 0.01, f"Mean weight {weights.mean()}"
+    mean_energy = np.sum(weights * sample) / np.sum(weights)
+    assert abs(mean_energy - 999 / 3 / 49.5) < 0.02, f"Weighted mean energy {mean_energy}"
+    print(f"  ✓ mean weight {weights.mean():.4f}, weighted mean energy {mean_energy:.3f} MeV (target 6.727)")
+
+    # ESS / N = E[w]^2 / E[w^2] = 1 / (81 * 333 / 49.5^2 / 9)
+    result = reweighter.diagnostics(sample, verbose=False)
+    expected_fraction = 49.5 ** 2 * 9 / (81 * 333)
+    assert result["neutrons"] == N_NEUTRONS
+    assert abs(result["ess_fraction"] - expected_fraction) < 0.01, f"ESS fraction {result['ess_fraction']}"
+    assert abs(result["max_weight"] - 9 * sample.max() / 49.5) < 1e-6
+    print(f"  ✓ ESS fraction {result['ess_fraction']:.4f} (expected {expected_fraction:.4f})")
+
+    print("✓ Lin reweighting matches the analytic target\n")
+
+def test_lin_units():
+    """Test that the Lin line is evaluated in its configured unit."""
+    print("Testing Lin energy units...")
+    # 1000 * E(keV) on 1-10 MeV is proportional to E, so reweighting to E is the identity
+    keV = SpectrumReweighter(target=lambda e: e, sampling=lin_config(1000.0, 10000.0, 1.0, 0.0, "keV"))
+    energies = np.linspace(1.0, 10.0, 7)
+    assert np.allclose(keV.weight(energies), 1.0, rtol=1e-6), keV.weight(energies)
+    print("  ✓ keV gradient")
+
+    # A 1-2 eV range is 1e-6 to 2e-6 MeV
+    eV = SpectrumReweighter(target=lambda e: np.ones_like(e), sampling=lin_config(1.0, 2.0, 1e-6, 1.0, "eV"))
+    assert np.allclose(eV.weight(np.array([1.2e-6, 1.8e-6])), 1.0, rtol=1e-5)
+    print("  ✓ eV range")
+
+    print("✓ Lin units applied\n")
+
+def test_hist_first_edge():
+    """Test that the first Hist point sets the lower edge and its intensity is ignored."""
+    print("Testing Hist first-edge convention...")
+    # Bins (1, 2] with 3 counts and (2, 4] with 1 count; the 99 is not a bin
+    sampling = Config(energy_type="Hist", energy_histogram=[(1.0, 99.0), (2.0, 3.0), (4.0, 1.0)],
+                      energy_unit="MeV")
+    reweighter = SpectrumReweighter(target=lambda e: np.ones_like(e), sampling=sampling)
+    assert (reweighter.sampling.emin, reweighter.sampling.emax) == (1.0, 4.0)
+
+    # Normalized densities 0.75 and 0.125 against a flat target of 1/3
+    weights = reweighter.weight(np.array([1.5, 3.0, 0.5, 5.0]))
+    assert np.allclose(weights, [1 / 3 / 0.75, 1 / 3 / 0.125, 0.0, 0.0], rtol=1e-3), weights
+    print(f"  ✓ weights {weights[0]:.4f} and {weights[1]:.4f} in the two bins, 0 outside")
+
+    # Target flux below the first edge is missing coverage
+    wide = SpectrumReweighter(target=([0.5, 4.0], [1.0, 1.0]), sampling=sampling)
+    assert abs(wide.coverage - 3.0 / 3.5) < 1e-3, wide.coverage
+    print(f"  ✓ coverage {wide.coverage:.4f} for a target starting at 0.5 MeV")
+
+    print("✓ Hist histogram read as GPS does\n")
+
+def test_diagnostics_apply_and_table():
+    """Test diagnostics on photon tables, apply and write_table."""
+    print("Testing diagnostics, apply and write_table...")
+    reweighter = SpectrumReweighter(target=lambda e: e, sampling=lin_config(1.0, 10.0, 0.0, 1.0))
+
+    # Three photons of neutron 0 and one of neutron 1; each neutron counts once
+    photons = pd.DataFrame({"neutron_id": [0, 0, 0, 1], "neutronEnergy": [2.0, 2.0, 2.0, 8.0],
+                            "weight": [0.5, 0.5, 0.5, 1.0]})
+    result = reweighter.diagnostics(photons, verbose=False)
+    weights = np.array([0.5, 1.0]) * reweighter.weight(np.array([2.0, 8.0]))
+    assert result["neutrons"] == 2
+    assert abs(result["effective_sample_size"] - weights.sum() ** 2 / np.sum(weights ** 2)) < 1e-9
+    assert set(result) == {"neutrons", "effective_sample_size", "ess_fraction", "max_weight", "coverage"}
+    print(f"  ✓ diagnostics: ESS {result['effective_sample_size']:.3f} of 2 neutrons")
+
+    applied = reweighter.apply(photons)
+    assert np.allclose(applied["weight"], photons["weight"] * reweighter.weight(photons["neutronEnergy"]))
+    assert np.allclose(photons["weight"], [0.5, 0.5, 0.5, 1.0]), "apply modified its input"
+    unweighted = reweighter.apply(photons.drop(columns="weight"))
+    assert np.allclose(unweighted["weight"], reweighter.weight(photons["neutronEnergy"]))
+    print("  ✓ apply multiplies the weight column, starting from 1 without one")
+
+    with tempfile.TemporaryDirectory() as tmp:
+        path = reweighter.write_table(Path(tmp) / "weights.txt", points=50)
+        assert path.read_text().startswith("# energy_MeV weight")
+        table = np.loadtxt(path)
+    assert table.shape == (50, 2)
+    assert np.allclose(table[:, 0], np.geomspace(1.0, 10.0, 50), rtol=1e-8)
+    assert np.allclose(table[:, 1], reweighter.weight(table[:, 0]), rtol=1e-8)
+    print("  ✓ write_table: 50 log-spaced points over the sampling range")
+
+    print("✓ Diagnostics, apply and table agree\n")
+
+def main():
+    """Run all tests."""
+    print("=" * 60)
+    print("Spectrum Reweighting Tests")
+    print("=" * 60 + "\n")
+
+    try:
+        test_lin_to_known_target()
+        test_lin_units()
+        test_hist_first_edge()
+        test_diagnostics_apply_and_table()
+
+        print("=" * 60)
+        print("ALL TESTS PASSED ✓")
+        print("=" * 60)
+        return 0
+    except Exception as e:
+        print("\n" + "=" * 60)
+        print("TEST FAILED ✗")
+        print("=" * 60)
+        print(f"Error: {e}")
+        import traceback
+        traceback.print_exc()
+        return 1
+
+if __name__ == "__main__":
+    sys.exit(main())
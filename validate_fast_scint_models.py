@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+"""
+Light-yield validation of the fast scintillator models against full HP transport.
+For each scintillator this script:
+1. Runs the same pencil beam twice, with HP transport and with fast_scint_models
+2. Compares the per-neutron light-yield spectra with Simulate.compare_light_yield
+3. Writes the spectra to <output>/<scintillator>_light_yield.csv and a summary table
+
+EJ200 is probed with 2 MeV neutrons (n-p elastic), GS20 with 25 meV neutrons (6Li(n,t)alpha).
+Needs the installed lumacam executables; it is a physics check, not a unit test, and takes
+minutes per scintillator at the default event count.
+
+Usage:
+    python validate_fast_scint_models.py [--events N] [--output DIR]
+"""
+
+import sys
+sys.path.insert(0, 'src')
+
+import argparse
+import os
+from pathlib import Path
+
+import numpy as np
+import pandas as pd
+from lumacam.simulate import Config, Simulate, VerbosityLevel
+
+CASES = {
+    "EJ200": (2.0, "MeV"),
+    "GS20": (0.025, "eV"),
+}
+
+def beam_config(scintillator, energy, unit, fast, events):
+    """Mono-energetic pencil beam on the scintillator centre with per-neutron summaries."""
+    return Config(
+        particle="neutron", energy=energy, energy_unit=unit, energy_type="Mono",
+        shape="Rectangle", halfx=0.5, halfy=0.5, shape_unit="mm", angle_type="beam1d",
+        scintillator=scintillator, sample_material="G4_Galactic",
+        fast_scint_models=fast, neutron_summary=True, write_photons=False,
+        num_events=events, progress_interval=max(events // 10, 1),
+    )
+
+def validate(scintillator, events, output):
+    """Run HP and fast models for one scintillator and compare their light-yield spectra."""
+    print(f"Validating {scintillator}...")
+    energy, unit = CASES[scintillator]
+    archives = {}
+    for label, fast in (("hp", False), ("fast", True)):
+        archive = output / f"{scintillator}_{label}"
+        sim = Simulate(archive=str(archive))
+        sim.run(beam_config(scintillator, energy, unit, fast, events), verbosity=VerbosityLevel.QUIET)
+        archives[label] = sim
+
+    spectra = archives["fast"].compare_light_yield(str(output / f"{scintillator}_hp"))
+    spectra.to_csv(output / f"{scintillator}_light_yield.csv", index=False)
+
+    light = archives["fast"].read_neutron_summary()["photon_weight"].to_numpy()
+    ref_light = archives["hp"].read_neutron_summary()["photon_weight"].to_numpy()
+    ks = np.max(np.abs(np.cumsum(spectra["spectrum"]) - np.cumsum(spectra["reference"])))
+    print(f"✓ {scintillator} compared\n")
+    return {"scintillator": scintillator, "energy": f"{energy:g} {unit}", "events": events,
+            "hp_mean": ref_light.mean(), "fast_mean": light.mean(),
+            "mean_ratio": light.mean() / ref_light.mean(),
+            "hp_zero_fraction": np.mean(ref_light == 0), "fast_zero_fraction": np.mean(light == 0),
+            "ks_distance": ks}
+
+def main():
+    """Validate every scintillator and write the summary table."""
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--events", type=int, default=20000, help="Neutrons per run")
+    parser.add_argument("--output", default="archive/fast_scint_validation", help="Directory for archives and results")
+    args = parser.parse_args()
+
+    print("=" * 60)
+    print("Fast Scintillator Model Validation")
+    print("=" * 60 + "\n")
+
+    output = Path(args.output).absolute()
+    output.mkdir(parents=True, exist_ok=True)
+    if not os.path.exists(Simulate(archive=str(output / "probe")).lumacam_executable):
+        print("lumacam executable not installed, nothing to validate")
+        return 1
+
+    summary = pd.DataFrame([validate(scintillator, args.events, output) for scintillator in CASES])
+    summary.to_csv(output / "summary.csv", index=False)
+
+    print("=" * 60)
+    print(summary.to_string(index=False, float_format=lambda v: f"{v:.4g}"))
+    print("=" * 60)
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,77 @@
+#!/usr/bin/env python3
+"""
+Check-mode run of the optical boundary fast path across the sensor.
+This script:
+1. Shoots optical photons along +x through SensorPhys, an air volume inside the air-filled
+   L-shape, to the DarkLShape wall behind it, with optical_fast_path "check"
+2. Parses the fast-path report, which counts every hit the shortcut claims and the ones where
+   the stock G4OpBoundaryProcess disagreed
+
+G4OpBoundaryProcess passes photons between volumes of the same material, so the sensor faces
+are no surface for it. Each photon must therefore be absorbed exactly once, at the housing
+wall, with no disagreement: absorber hits equal to the photon count and zero mismatches.
+Needs the installed lumacam executables.
+
+Usage:
+    python validate_optical_fast_path.py [--events N] [--output DIR]
+"""
+
+import sys
+sys.path.insert(0, 'src')
+
+import argparse
+import os
+import re
+import subprocess
+from pathlib import Path
+
+from lumacam.simulate import Config, Simulate
+
+REPORT = re.compile(r"(\w+) hits: (\d+), disagreeing with G4OpBoundaryProcess: (\d+)")
+
+def sensor_beam(events):
+    """Optical pencil beam from the L-shape arm into the sensor face at x = 30 cm."""
+    return Config(
+        particle="opticalphoton", energy=3.0, energy_unit="eV",
+        position_x=20.0, position_y=0.0, position_z=20.0, position_unit="cm",
+        direction_x=1.0, direction_y=0.0, direction_z=0.0,
+        shape="Rectangle", halfx=1.0, halfy=1.0, shape_unit="mm", angle_type="planar",
+        sample_material="G4_Galactic", optical_fast_path="check", write_photons=False,
+        num_events=events, progress_interval=max(events // 10, 1),
+    )
+
+def main():
+    """Run the check-mode beam and compare the fast-path report with the stock process."""
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--events", type=int, default=10000, help="Optical photons")
+    parser.add_argument("--output", default="archive/optical_fast_path_check", help="Archive directory")
+    args = parser.parse_args()
+
+    print("=" * 60)
+    print("Optical Fast Path Check at the Sensor")
+    print("=" * 60 + "\n")
+
+    sim = Simulate(archive=args.output)
+    if not os.path.exists(sim.lumacam_executable):
+        print("lumacam executable not installed, nothing to check")
+        return 1
+    macro = sensor_beam(args.events).write(str(Path(sim.archive) / "macro.mac"))
+    result = subprocess.run([sim.lumacam_executable, macro], cwd=sim.archive, capture_output=True, text=True)
+    if result.returncode != 0:
+        print(result.stderr)
+        return 1
+
+    report = {name: (int(hits), int(mismatches)) for name, hits, mismatches in REPORT.findall(result.stdout)}
+    for name, (hits, mismatches) in report.items():
+        print(f"  {name}: {hits} hits, {mismatches} disagreeing with G4OpBoundaryProcess")
+    hits = report.get("absorber", (0, 0))[0]
+    passed = hits == args.events and sum(m for _, m in report.values()) == 0
+
+    print("\n" + "=" * 60)
+    print("SENSOR BOUNDARY MATCHES ✓" if passed else
+          f"SENSOR BOUNDARY DIFFERS ✗ ({hits} absorber hits for {args.events} photons)")
+    print("=" * 60)
+    return 0 if passed else 1
+
+if __name__ == "__main__":
+    sys.exit(main())